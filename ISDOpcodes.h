@@ -244,8 +244,10 @@ enum NodeType {
   SREM,
   UREM,
 
-  // Perform a * b + c against integers 
-  IMAD, // 2022130828 
+  // riscv-gen: begin isd (generated from riscv-custom.spec)
+  // Perform a * b + c against integers
+  IMAD,
+  // riscv-gen: end isd
 
   /// SMUL_LOHI/UMUL_LOHI - Multiply two integers of type iN, producing
   /// a signed/unsigned value of type i[2*N], and return the full value as
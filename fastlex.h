@@ -0,0 +1,216 @@
+#ifndef FASTLEX_H
+#define FASTLEX_H
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "intern.h"
+
+/* =====HAND-WRITTEN LEXER===== */
+/*  Produces the same tokens, lexemes and line numbers as the flex rules in
+    project2.l, for input that is entirely in memory (a mapped file).
+    Blank runs and identifier runs are classified 16 bytes at a time with
+    SSE2 (scalar fallback otherwise), comment bodies are skipped with memchr,
+    and keywords go through a perfect hash. Quirks of the flex rules are kept
+    on purpose so both backends give the same stream: newlines inside block
+    comments are not counted, a block comment is the longest match of
+    "/\*([^*]|\*+[^/])*\*\/", and characters no rule matches are echoed
+    like flex's default rule does.
+    Include after the token definitions (YYSTYPE, INT, ID, ...). */
+
+typedef struct FASTLEX {
+    const char* cur;
+    const char* end;
+    int         lineno;
+    INTERNTAB*  strings;
+    FILE*       echo;       /* where unmatched characters go (flex: yyout) */
+    const char* text;       /* lexeme of the last token, for yyerror */
+} FASTLEX;
+
+static inline void FastLexInit(FASTLEX* lex, const char* text, size_t len, INTERNTAB* strings) {
+    lex->cur = text;
+    lex->end = text + len;
+    lex->lineno = 1;
+    lex->strings = strings;
+    lex->echo = stdout;
+    lex->text = "";
+}
+
+/* First byte at or after p that is not ' ', '\t' or '\r' */
+static inline const char* FastSkipBlanks(const char* p, const char* end) {
+#ifdef __SSE2__
+    const __m128i sp = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, tab)),
+                                     _mm_cmpeq_epi8(v, cr));
+        unsigned int mask = ~_mm_movemask_epi8(blank) & 0xffff;
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+    return p;
+}
+
+static inline int FastIsIdent(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+/* End of the [a-zA-Z_0-9]* run starting at p */
+static inline const char* FastIdentEnd(const char* p, const char* end) {
+#ifdef __SSE2__
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i a = _mm_set1_epi8('a' - 1), z = _mm_set1_epi8('z' + 1);
+    const __m128i d0 = _mm_set1_epi8('0' - 1), d9 = _mm_set1_epi8('9' + 1);
+    const __m128i us = _mm_set1_epi8('_');
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        __m128i lower = _mm_or_si128(v, case_bit);     // bytes >= 0x80 stay negative and fail both ranges
+        __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, a), _mm_cmplt_epi8(lower, z));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, d0), _mm_cmplt_epi8(v, d9));
+        __m128i ident = _mm_or_si128(_mm_or_si128(alpha, digit), _mm_cmpeq_epi8(v, us));
+        unsigned int mask = ~_mm_movemask_epi8(ident) & 0xffff;
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && FastIsIdent(*p)) p++;
+    return p;
+}
+
+/* Perfect hash over int/void/if/else/for/continue/float: (4*c0 + 6*len + c1) & 7 */
+static inline int FastKeyword(const char* s, size_t len) {
+    static const struct { const char* word; int token; } table[8] = {
+        { "else", ELSE }, { "for", FOR }, { "float", FLOAT }, { "continue", CONTINUE },
+        { "int", INT }, { NULL, 0 }, { "if", IF }, { "void", VOID }
+    };
+    if (len < 2 || len > 8) return 0;
+    int h = (4 * (unsigned char)s[0] + 6 * (int)len + (unsigned char)s[1]) & 7;
+    const char* word = table[h].word;
+    if (word != NULL && strlen(word) == len && !memcmp(word, s, len)) return table[h].token;
+    return 0;
+}
+
+/* End of the block comment opened at p ("/" "*"), or NULL if the flex rule does not match */
+static inline const char* FastBlockCommentEnd(const char* p, const char* end) {
+    // ([^*]|\*+[^/])* \*\/ 의 DFA: 0 = 본문, 1 = '*' 하나, 2 = "**", 3 = "***..."(닫을 수도 계속할 수도)
+    const char* accept = NULL;
+    int state = 0;
+    p += 2;
+    while (p < end) {
+        if (state == 0) {
+            p = (const char*)memchr(p, '*', end - p);
+            if (p == NULL) break;
+            state = 1;
+            p++;
+            continue;
+        }
+        char c = *p++;
+        if (state == 1) {
+            if (c == '/') return p;             // 더 길게 match될 수 없음
+            state = (c == '*') ? 2 : 0;
+        } else if (state == 2) {
+            state = (c == '*') ? 3 : 0;
+        } else {
+            if (c == '/') accept = p;           // 여기서 끝날 수도 있지만 flex는 더 긴 match를 찾는다
+            state = (c == '*') ? 3 : 0;
+        }
+    }
+    return accept;
+}
+
+static inline int FastToken(FASTLEX* lex, YYSTYPE* lval, const char* start, const char* stop, int token) {
+    lval->string = InternIn(lex->strings, start, stop - start);
+    lex->text = lval->string;
+    lex->cur = stop;
+    return token;
+}
+
+/* Next token, 0 at the end of the input */
+static inline int FastLex(FASTLEX* lex, YYSTYPE* lval) {
+    const char* end = lex->end;
+    for (;;) {
+        const char* p = FastSkipBlanks(lex->cur, end);
+        if (p >= end) {
+            lex->cur = end;
+            lex->text = "";
+            return 0;
+        }
+        char c = *p;
+        char n = (p + 1 < end) ? p[1] : '\0';
+
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') {
+            const char* q = FastIdentEnd(p + 1, end);
+            int keyword = FastKeyword(p, q - p);
+            return FastToken(lex, lval, p, q, keyword ? keyword : ID);
+        }
+        if (c >= '0' && c <= '9') {
+            const char* q = p + 1;
+            if (c == '0' && (n == 'x' || n == 'X') && p + 2 < end && isxdigit((unsigned char)p[2])) {
+                for (q = p + 3; q < end && isxdigit((unsigned char)*q); q++);
+                return FastToken(lex, lval, p, q, NUM_HEX);
+            }
+            if (c == '0' && (n == 'b' || n == 'B') && p + 2 < end && (p[2] == '0' || p[2] == '1')) {
+                for (q = p + 3; q < end && (*q == '0' || *q == '1'); q++);
+                return FastToken(lex, lval, p, q, NUM_BIN);
+            }
+            while (q < end && *q >= '0' && *q <= '9') q++;
+            return FastToken(lex, lval, p, q, NUM);
+        }
+
+        switch (c) {
+        case '\n':
+            lex->lineno++;
+            lex->cur = p + 1;
+            continue;
+        case '/':
+            if (n == '/') {
+                const char* q = (const char*)memchr(p, '\n', end - p);
+                lex->cur = q ? q : end;
+                continue;
+            }
+            if (n == '*') {
+                const char* q = FastBlockCommentEnd(p, end);
+                if (q != NULL) {
+                    lex->cur = q;
+                    continue;
+                }
+            }
+            return FastToken(lex, lval, p, p + 1, OP_MUL);
+        case '*': return FastToken(lex, lval, p, p + 1, OP_MUL);
+        case '=': return n == '=' ? FastToken(lex, lval, p, p + 2, OP_REL) : FastToken(lex, lval, p, p + 1, OP_ASSIGN);
+        case '+':
+            if (n == '=') return FastToken(lex, lval, p, p + 2, OP_ASSIGN);
+            if (n == '+') return FastToken(lex, lval, p, p + 2, OP_INC);
+            return FastToken(lex, lval, p, p + 1, OP_ADD);
+        case '-': return n == '-' ? FastToken(lex, lval, p, p + 2, OP_DEC) : FastToken(lex, lval, p, p + 1, OP_ADD);
+        case '<':
+        case '>': return FastToken(lex, lval, p, p + (n == '=' ? 2 : 1), OP_REL);
+        case '!': if (n == '=') return FastToken(lex, lval, p, p + 2, OP_REL); break;
+        case '&': if (n == '&') return FastToken(lex, lval, p, p + 2, OP_LOGIC); break;
+        case '|': if (n == '|') return FastToken(lex, lval, p, p + 2, OP_LOGIC); break;
+        case '(': return FastToken(lex, lval, p, p + 1, LPAREN);
+        case ')': return FastToken(lex, lval, p, p + 1, RPAREN);
+        case '{': return FastToken(lex, lval, p, p + 1, LBRACE);
+        case '}': return FastToken(lex, lval, p, p + 1, RBRACE);
+        case '[': return FastToken(lex, lval, p, p + 1, LBRACKET);
+        case ']': return FastToken(lex, lval, p, p + 1, RBRACKET);
+        case ',': return FastToken(lex, lval, p, p + 1, COMMA);
+        case ';': return FastToken(lex, lval, p, p + 1, SEMICOLON);
+        case '#':
+            if (end - p >= 7 && !memcmp(p, "#define", 7)) return FastToken(lex, lval, p, p + 7, DEFINE);
+            break;
+        }
+        // 어떤 rule에도 안 걸리는 글자는 flex 기본 rule처럼 그대로 출력
+        fputc(c, lex->echo);
+        lex->cur = p + 1;
+    }
+}
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* =====STRING INTERNING===== */
+/*  Lexemes and token labels ("ID: foo") are stored once per parse in an
+    INTERNTAB and shared by every token and node that spells them, so the
+    lexer and the parse tree do no per-token allocation. The strings stay
+    valid until FreeInternTab, i.e. for as long as the tree is kept. */
+
+#define INTERN_BLOCK_SIZE 16384
+
+typedef struct INTERNBLOCK {
+    struct INTERNBLOCK* next;
+    size_t used;
+    size_t size;
+    char data[];
+} INTERNBLOCK;
+
+typedef struct INTERNTAB {
+    INTERNBLOCK*  blocks;
+    char**        slot;      /* open addressing, NULL = empty */
+    unsigned int* hash;      /* hash of slot[i] */
+    int           num_item;
+    int           num_slot;  /* power of two, at least 2 * num_item */
+} INTERNTAB;
+
+/* Table CreateTokenNode interns into on this thread (set around each parse).
+   The scanner gets the same table through yyextra (yylex_init_extra). */
+static _Thread_local INTERNTAB* curInternTab = NULL;
+
+static inline INTERNTAB* UseInternTab(INTERNTAB* tab) {
+    INTERNTAB* prev = curInternTab;
+    curInternTab = tab;
+    return prev;
+}
+
+static inline unsigned int HashBytes(const char* data, size_t len) {
+    unsigned int h = 2166136261u;    /* FNV-1a */
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static inline char* InternCopy(INTERNTAB* tab, const char* s, size_t len) {
+    INTERNBLOCK* block = tab->blocks;
+    if (block == NULL || block->used + len + 1 > block->size) {
+        size_t size = len + 1 > INTERN_BLOCK_SIZE ? len + 1 : INTERN_BLOCK_SIZE;
+        block = (INTERNBLOCK*)malloc(sizeof(INTERNBLOCK) + size);
+        block->used = 0;
+        block->size = size;
+        block->next = tab->blocks;
+        tab->blocks = block;
+    }
+    char* p = block->data + block->used;
+    memcpy(p, s, len);
+    p[len] = '\0';
+    block->used += len + 1;
+    return p;
+}
+
+static inline void RehashInternTab(INTERNTAB* tab, int numSlot) {
+    char** slot = (char**)calloc(numSlot, sizeof(char*));
+    unsigned int* hash = (unsigned int*)malloc(sizeof(unsigned int) * numSlot);
+    for (int i = 0; i < tab->num_slot; i++) {
+        if (tab->slot[i] == NULL) continue;
+        int j = tab->hash[i] & (numSlot - 1);
+        while (slot[j] != NULL) j = (j + 1) & (numSlot - 1);
+        slot[j] = tab->slot[i];
+        hash[j] = tab->hash[i];
+    }
+    free(tab->slot);
+    free(tab->hash);
+    tab->slot = slot;
+    tab->hash = hash;
+    tab->num_slot = numSlot;
+}
+
+/* The unique copy of s[0..len) in tab */
+static inline char* InternIn(INTERNTAB* tab, const char* s, size_t len) {
+    unsigned int h = HashBytes(s, len);
+    if (tab->num_slot != 0) {
+        int j = h & (tab->num_slot - 1);
+        while (tab->slot[j] != NULL) {
+            char* p = tab->slot[j];
+            if (tab->hash[j] == h && !strncmp(p, s, len) && p[len] == '\0') return p;
+            j = (j + 1) & (tab->num_slot - 1);
+        }
+    }
+    if ((tab->num_item + 1) * 2 > tab->num_slot) {
+        RehashInternTab(tab, tab->num_slot ? tab->num_slot * 2 : 256);
+    }
+    int j = h & (tab->num_slot - 1);
+    while (tab->slot[j] != NULL) j = (j + 1) & (tab->num_slot - 1);
+    tab->slot[j] = InternCopy(tab, s, len);
+    tab->hash[j] = h;
+    tab->num_item += 1;
+    return tab->slot[j];
+}
+
+static inline char* Intern(const char* s, size_t len) {
+    return InternIn(curInternTab, s, len);
+}
+
+static inline void FreeInternTab(INTERNTAB* tab) {
+    while (tab->blocks != NULL) {
+        INTERNBLOCK* next = tab->blocks->next;
+        free(tab->blocks);
+        tab->blocks = next;
+    }
+    free(tab->slot);
+    free(tab->hash);
+    tab->slot = NULL;
+    tab->hash = NULL;
+    tab->num_item = 0;
+    tab->num_slot = 0;
+}
+
+#endif
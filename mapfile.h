@@ -0,0 +1,65 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* =====MAPPED SOURCE FILES===== */
+/*  Lets a flex scanner run straight over the file with yy_scan_buffer
+    instead of copying it through yyin. flex needs two NUL bytes after the
+    text and writes into the buffer while scanning (yy_hold_char), so the
+    file is mapped private and writable, on top of a reserved anonymous
+    region that supplies the zero bytes past the end of the file. */
+
+typedef struct MAPPEDFILE {
+    char*  data;     /* file contents followed by two '\0' */
+    size_t len;      /* file size; pass len + 2 to yy_scan_buffer */
+    size_t map_len;  /* size of the whole mapping */
+} MAPPEDFILE;
+
+/* Map a regular, non-empty file. Returns false for stdin ("-"), pipes,
+   devices, empty files and mmap failures; the caller then reads through FILE*. */
+static inline bool MapSourceFile(const char* path, MAPPEDFILE* map) {
+    if (path[0] == '-' && path[1] == '\0') return false;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    size_t len = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapLen = (len + 2 + page - 1) / page * page;
+
+    // 먼저 0으로 찬 영역을 잡고, 그 위에 파일을 덮어서 끝의 NUL 두 개를 보장한다
+    char* base = (char*)mmap(NULL, mapLen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    if (mmap(base, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, mapLen);
+        close(fd);
+        return false;
+    }
+    close(fd);
+    madvise(base, len, MADV_SEQUENTIAL);
+
+    map->data = base;
+    map->len = len;
+    map->map_len = mapLen;
+    return true;
+}
+
+static inline void UnmapSourceFile(MAPPEDFILE* map) {
+    if (map->data != NULL) munmap(map->data, map->map_len);
+    map->data = NULL;
+}
+
+#endif
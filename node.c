@@ -4,6 +4,8 @@
 #include <stdlib.h>
 
 
+#define NODE_TYPE_UNSET -2   /* type slot not computed yet */
+
 typedef struct NODE{
 	//todo: define struct NODE
     char* name;
@@ -11,19 +13,35 @@ typedef struct NODE{
 	struct NODE* child;
 	struct NODE* prev;
 	struct NODE* next;
+	int type;            /* memoized expression type (see GetExprType) */
 }NODE;
 
 
 //MakeNode: make a new node
+// name은 복사하지 않는다: rule 이름은 string literal, token label은 intern.h에 있어서 tree보다 오래 산다
 NODE* MakeNode(char* name){
 	//todo	
 	NODE* newNode = (NODE*)malloc(sizeof(NODE));
-	newNode->name = (char*)malloc(strlen(name) + 1);
-	strcpy(newNode->name, name);
+	newNode->name = name;
 	newNode -> parent = NULL;
 	newNode -> child = NULL;
 	newNode -> prev = NULL;
 	newNode -> next = NULL;
+	newNode -> type = NODE_TYPE_UNSET;
+	return newNode;
+}
+
+// MakeNumberNode: "NUM: value" leaf for a folded constant; the label is allocated with the node, so FreeTree frees both
+NODE* MakeNumberNode(int value){
+	NODE* newNode = (NODE*)malloc(sizeof(NODE) + 24);
+	char* label = (char*)(newNode + 1);
+	snprintf(label, 24, "NUM: %d", value);
+	newNode->name = label;
+	newNode -> parent = NULL;
+	newNode -> child = NULL;
+	newNode -> prev = NULL;
+	newNode -> next = NULL;
+	newNode -> type = NODE_TYPE_UNSET;
 	return newNode;
 }
 
@@ -65,6 +83,16 @@ void WalkTree(NODE* node){
 	}
 }
 
+// FreeTree: free a node, its children and its following siblings (names are not owned)
+void FreeTree(NODE* node){
+	while (node != NULL) {
+		NODE* next = node->next;
+		FreeTree(node->child);
+		free(node);
+		node = next;
+	}
+}
+
 // int main(void) {
 // 	NODE* A = MakeNode("A");
 // 	NODE* B = MakeNode("B");
@@ -5,17 +5,32 @@
 #include <stdarg.h>
 #include <string.h>
 #include "node.c"
-
-
-NODE *head;
-char buf[100];
-FILE* fp;
-
-extern FILE *yyin;
-extern char *yytext;
-
-extern int yylineno;
-char * filename;
+#include "intern.h"
+#include "mapfile.h"
+
+
+/* Everything one parse needs; project2.l is a reentrant scanner */
+typedef struct PARSECTX {
+    const char* filename;
+    NODE* head;             /* root of the parse tree (c_code) */
+} PARSECTX;
+
+/* reentrant flex scanner API (project2.l) */
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+int yylex_init_extra(struct INTERNTAB* strings, yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+#ifndef YY_TYPEDEF_YY_BUFFER_STATE
+#define YY_TYPEDEF_YY_BUFFER_STATE
+typedef struct yy_buffer_state* YY_BUFFER_STATE;
+#endif
+void yyset_in(FILE* in, yyscan_t scanner);
+YY_BUFFER_STATE yy_scan_buffer(char* base, size_t size, yyscan_t scanner);
+void yyset_lineno(int line, yyscan_t scanner);
+int yyget_lineno(yyscan_t scanner);
+char* yyget_text(yyscan_t scanner);
 
 typedef union {
     int number;
@@ -30,14 +45,10 @@ typedef struct {
     MyValue val;
 } SymbolSpec;
 
-int yylex();
-
-void yyerror(const char *str)
+void yyerror(yyscan_t scanner, PARSECTX* ctx, const char *str)
 {
-    fprintf(stderr, "%s:%d: error: %s '%s' token \n", filename, yylineno, str, yytext);
+    fprintf(stderr, "%s:%d: error: %s '%s' token \n", ctx->filename, yyget_lineno(scanner), str, yyget_text(scanner));
 }
-
-int yywrap(){ return 1; }
     
 NODE* CreateTokenNode(char* token_type, char* token_value);
 NODE* BuildRuleNode(char* rulename, SymbolSpec* specs, int count);
@@ -45,7 +56,24 @@ NODE* LastChild(NODE* parent);
 
 %}
 
+%code requires {
+typedef struct NODE NODE;
+typedef struct PARSECTX PARSECTX;
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+}
+
+%code {
+int yylex(YYSTYPE* yylval_param, yyscan_t scanner);
+}
+
 /**********GRAMMAR AREA**********/
+%define api.pure full
+%lex-param   { yyscan_t scanner }
+%parse-param { yyscan_t scanner } { PARSECTX* ctx }
+
 %union {
     int number;
     char *string;
@@ -54,7 +82,7 @@ NODE* LastChild(NODE* parent);
 
 /* Tokens */
 %token <string> DEFINE
-%token <string> INT VOID
+%token <string> INT FLOAT VOID
 %token <string> IF FOR ELSE
 %token <string> CONTINUE
 %token <string> OP_ASSIGN OP_INC OP_DEC OP_ADD OP_MUL OP_LOGIC OP_REL
@@ -94,7 +122,7 @@ c_code:
             { SYM_NODE, NULL, { .node = $1 } }
         };
         $$ = BuildRuleNode("c_code", specs, 1);
-		head = $$;
+		ctx->head = $$;
 	}
 	| c_code code {
 		SymbolSpec specs[] = {
@@ -102,7 +130,7 @@ c_code:
 			{ SYM_NODE, NULL, { .node = $2 } }
         };
         $$ = BuildRuleNode("c_code", specs, 2);
-		head = $$;
+		ctx->head = $$;
 	};
 
 code:
@@ -533,10 +561,13 @@ type:
 //THIS AREA WILL BE COPIED TO y.tab.c CODE
 
 NODE* CreateTokenNode(char* token_type, char* token_value) {
-    NODE* node = MakeNode(token_type);
+    // "TYPE: lexeme" label도 intern해서 같은 token끼리 하나를 같이 쓴다
+    size_t len = strlen(token_type) + 2 + strlen(token_value);
+    char small[128];
+    char* buf = len < sizeof(small) ? small : (char*)malloc(len + 1);
     sprintf(buf, "%s: %s", token_type, token_value);
-    free(node->name);
-    node->name = strdup(buf);
+    NODE* node = MakeNode(Intern(buf, len));
+    if (buf != small) free(buf);
     return node;
 }
 
@@ -624,16 +655,35 @@ int main(int argc, char **argv)
         return 2;
     }
 
-    yyin = fopen(argv[1], "r");
-    if (!yyin) {
-        fprintf(stderr, "cannot open %s\n", argv[1]);
-        return 2;
+    // regular file는 mmap해서 바로 scan, stdin("-")/pipe는 FILE*로
+    MAPPEDFILE map = { NULL, 0, 0 };
+    FILE* in = NULL;
+    if (!MapSourceFile(argv[1], &map)) {
+        in = strcmp(argv[1], "-") ? fopen(argv[1], "r") : stdin;
+        if (!in) {
+            fprintf(stderr, "cannot open %s\n", argv[1]);
+            return 2;
+        }
     }
-    filename = argv[1];
-
-    yyparse();
-    WalkTree(head);
-
-    fclose(yyin);
+    PARSECTX ctx = { argv[1], NULL };
+    INTERNTAB strings = { 0 };
+    UseInternTab(&strings);
+
+    yyscan_t scanner;
+    yylex_init_extra(&strings, &scanner);
+    if (map.data != NULL) {
+        yy_scan_buffer(map.data, map.len + 2, scanner);
+        yyset_lineno(1, scanner);   // yy_scan_buffer는 line number를 초기화하지 않는다
+    } else {
+        yyset_in(in, scanner);
+    }
+    yyparse(scanner, &ctx);
+    yylex_destroy(scanner);
+    WalkTree(ctx.head);
+    FreeTree(ctx.head);
+    FreeInternTab(&strings);
+
+    if (in != NULL && in != stdin) fclose(in);
+    UnmapSourceFile(&map);
     return 0;
 }
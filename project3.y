@@ -4,19 +4,39 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <time.h>
 #include "symtab.h"
+#include "mapfile.h"
 
-#define MAX_SCOPE_ERRORS 128
-#define MAX_TYPE_ERRORS 128 
+/* Everything one parse needs, so several files can be parsed at the same time */
+typedef struct PARSECTX {
+    const char* filename;
+    NODE* head;             /* root of the parse tree (c_code) */
+    FILE* err;              /* syntax errors go here */
+    struct FASTLEX* fast;   /* hand-written lexer (fastlex.h), NULL = flex */
+} PARSECTX;
 
-NODE *head;
-char buf[100];
-FILE* fp;
-
-extern FILE *yyin;
-extern char *yytext;
-extern int yylineno;
-char * filename;
+/* reentrant flex scanner API (project2.l) */
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+int yylex_init_extra(struct INTERNTAB* strings, yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+#ifndef YY_TYPEDEF_YY_BUFFER_STATE
+#define YY_TYPEDEF_YY_BUFFER_STATE
+typedef struct yy_buffer_state* YY_BUFFER_STATE;
+#endif
+void yyset_in(FILE* in, yyscan_t scanner);
+void yyset_out(FILE* out, yyscan_t scanner);
+YY_BUFFER_STATE yy_scan_bytes(const char* bytes, int len, yyscan_t scanner);
+YY_BUFFER_STATE yy_scan_buffer(char* base, size_t size, yyscan_t scanner);
+void yyset_lineno(int line, yyscan_t scanner);
+int yyget_lineno(yyscan_t scanner);
+char* yyget_text(yyscan_t scanner);
 
 typedef union {
     int number;
@@ -31,23 +51,40 @@ typedef struct {
     MyValue val;
 } SymbolSpec;
 
-int yylex();
-
-void yyerror(const char *str){
-    fprintf(stderr, "%s:%d: error: %s '%s' token \n", filename, yylineno, str, yytext);
-}
-
-int yywrap(){
-     return 1; 
-}
-
+void yyerror(yyscan_t scanner, PARSECTX* ctx, const char *str);
 NODE* CreateTokenNode(char* token_type, char* token_value);
 NODE* BuildRuleNode(char* rulename, SymbolSpec* specs, int count);
 
 
 %}
 
+%code requires {
+typedef struct NODE NODE;
+typedef struct PARSECTX PARSECTX;
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+}
+
+%code {
+int yylex(YYSTYPE* yylval_param, yyscan_t scanner);
+#include "fastlex.h"
+
+/* The parser asks for tokens here; ctx->fast picks the backend */
+static int DispatchLex(YYSTYPE* lval, yyscan_t scanner, PARSECTX* ctx);
+#define yylex DispatchLex
+}
+
 /**********GRAMMAR AREA**********/
+%define api.pure full
+%lex-param   { yyscan_t scanner } { PARSECTX* ctx }
+%token-table
+
+/* subtrees thrown away during error recovery; the tree kept in ctx->head survives */
+%destructor { if ($$ != ctx->head) FreeTree($$); } <node>
+%parse-param { yyscan_t scanner } { PARSECTX* ctx }
+
 %union { 
     int number; 
     char *string; 
@@ -95,7 +132,7 @@ c_code:
             { SYM_NODE, NULL, { .node = $1 } }
         };
         $$ = BuildRuleNode("c_code", specs, 1);
-		head = $$;
+		ctx->head = $$;
 	}
 	| c_code code {
 		SymbolSpec specs[] = {
@@ -103,7 +140,7 @@ c_code:
 			{ SYM_NODE, NULL, { .node = $2 } }
         };
         $$ = BuildRuleNode("c_code", specs, 2);
-		head = $$;
+		ctx->head = $$;
 	};
 
 code:
@@ -144,6 +181,34 @@ func_def:
 			{ SYM_TOKEN, "RBRACE", { .string = $8 } },
 		};
 		$$ = BuildRuleNode("func_def", specs, 8);
+	}
+	/* error recovery: a broken parameter list or a body that cannot be resynchronized
+	   at a statement still gives a func_def, with an "error" node in place of the bad part */
+	| type ID LPAREN error RPAREN LBRACE body_list RBRACE {
+		SymbolSpec specs[] = {
+			{ SYM_NODE, NULL, {.node = $1} },
+			{ SYM_TOKEN, "ID", { .string = $2 } },
+			{ SYM_TOKEN, "LPAREN", { .string = $3 } },
+			{ SYM_NODE, NULL, { .node = MakeNode("error") } },
+			{ SYM_TOKEN, "RPAREN", { .string = $5 } },
+			{ SYM_TOKEN, "LBRACE", { .string = $6 } },
+			{ SYM_NODE, NULL, { .node = $7 } },
+			{ SYM_TOKEN, "RBRACE", { .string = $8 } },
+		};
+		$$ = BuildRuleNode("func_def", specs, 8);
+	}
+	| type ID LPAREN func_arg_dec RPAREN LBRACE error RBRACE {
+		SymbolSpec specs[] = {
+			{ SYM_NODE, NULL, {.node = $1} },
+			{ SYM_TOKEN, "ID", { .string = $2 } },
+			{ SYM_TOKEN, "LPAREN", { .string = $3 } },
+			{ SYM_NODE, NULL, { .node = $4 } },
+			{ SYM_TOKEN, "RPAREN", { .string = $5 } },
+			{ SYM_TOKEN, "LBRACE", { .string = $6 } },
+			{ SYM_NODE, NULL, { .node = MakeNode("error") } },
+			{ SYM_TOKEN, "RBRACE", { .string = $8 } },
+		};
+		$$ = BuildRuleNode("func_def", specs, 8);
 	};
 
 func_arg_dec:
@@ -258,6 +323,31 @@ clause:
         };
         $$ = BuildRuleNode("clause", specs, 11);				
 	}
+	/* error recovery: a broken for/if header keeps its body */
+	| FOR LPAREN error RPAREN LBRACE body_list RBRACE {
+		SymbolSpec specs[] = {
+            { SYM_TOKEN, "FOR", { .string = $1 } },
+            { SYM_TOKEN, "LPAREN", { .string = $2 } },
+            { SYM_NODE,  NULL, { .node   = MakeNode("error") } },
+            { SYM_TOKEN, "RPAREN", { .string = $4 } },
+            { SYM_TOKEN, "LBRACE", { .string = $5 } },
+            { SYM_NODE,  NULL, { .node   = $6 } },
+            { SYM_TOKEN, "RBRACE", { .string = $7 } },
+        };
+        $$ = BuildRuleNode("clause", specs, 7);
+	}
+	| IF LPAREN error RPAREN LBRACE body_list RBRACE %prec LOWER_THAN_ELSE {
+		SymbolSpec specs[] = {
+            { SYM_TOKEN, "IF", { .string = $1 } },
+            { SYM_TOKEN, "LPAREN", { .string = $2 } },
+            { SYM_NODE,  NULL, { .node   = MakeNode("error") } },
+            { SYM_TOKEN, "RPAREN", { .string = $4 } },
+            { SYM_TOKEN, "LBRACE", { .string = $5 } },
+            { SYM_NODE,  NULL, { .node   = $6 } },
+            { SYM_TOKEN, "RBRACE", { .string = $7 } },
+        };
+        $$ = BuildRuleNode("clause", specs, 7);
+	}
 	;
 
 statement:
@@ -286,6 +376,7 @@ statement:
 
 	|error SEMICOLON
 	{
+		$$ = MakeNode("error");     // 이전에는 $$가 쓰레기 값이었다
 		yyerrok;
 	};
 
@@ -536,12 +627,220 @@ type:
 
 /**********EPILOGUE AREAR AREA**********/
 //THIS AREA WILL BE COPIED TO y.tab.c CODE
+#undef yylex
+
+/* =====PROFILING===== */
+/*  --profile: where the time of one file goes. Each phase records its wall
+    time and the symbol arena's size when it ends; node, symbol and string
+    counts are taken from the finished structures afterwards, so a run
+    without --profile only pays a NULL check per token. */
+
+#define PROFILE_TEXT 1
+#define PROFILE_JSON 2
+#define PROFILE_MAX_PHASE 8
+#define PROFILE_MAX_LABEL 64
+
+typedef struct PHASESTAT {
+    const char* name;
+    double ms;
+    size_t arenaBytes;      /* symbol arena bytes in use when the phase ended */
+    int    arenaBlocks;     /* blocks (mallocs) of the symbol arena at that point */
+} PHASESTAT;
+
+typedef struct LABELSTAT {
+    char label[24];         /* node label up to ':' ("ID: x" -> "ID"); token labels die with the tree */
+    int  len;
+    int  count;
+} LABELSTAT;
+
+typedef struct PROFILE {
+    double     mark;        /* start of the phase being measured */
+    PHASESTAT  phase[PROFILE_MAX_PHASE];
+    int        num_phase;
+    double     lexMs;       /* part of the parse phase spent in the lexer */
+    long       numToken;
+    int        numNode;
+    int        numScope;
+    int        numSymbol;
+    int        numString;
+    size_t     stringBytes;
+    int        stringBlocks;
+    LABELSTAT  label[PROFILE_MAX_LABEL];
+    int        num_label;
+} PROFILE;
+
+/* Profile of the file this thread is analyzing, NULL when not profiling */
+static _Thread_local PROFILE* curProfile = NULL;
+
+static double ProfileClock(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static PROFILE* StartProfile(PROFILE* prof){
+    memset(prof, 0, sizeof(PROFILE));
+    prof->mark = ProfileClock();
+    return prof;
+}
+
+static PROFILE* UseProfile(PROFILE* prof){
+    PROFILE* prev = curProfile;
+    curProfile = prof;
+    return prev;
+}
+
+/* End the current phase. A phase that is entered again adds up. */
+static void ProfilePhase(const char* name){
+    if (curProfile == NULL) return;
+    double now = ProfileClock();
+    PHASESTAT* phase = NULL;
+    for (int i = 0; i < curProfile->num_phase; i++) {
+        if (!strcmp(curProfile->phase[i].name, name)) phase = &curProfile->phase[i];
+    }
+    if (phase == NULL && curProfile->num_phase < PROFILE_MAX_PHASE) {
+        phase = &curProfile->phase[curProfile->num_phase++];
+        phase->name = name;
+    }
+    if (phase != NULL) {
+        phase->ms += now - curProfile->mark;
+        phase->arenaBytes = 0;
+        phase->arenaBlocks = 0;
+        pthread_mutex_lock(&curSymArena->lock);
+        for (ARENABLOCK* b = curSymArena->blocks; b != NULL; b = b->next) {
+            phase->arenaBytes += b->used;
+            phase->arenaBlocks++;
+        }
+        pthread_mutex_unlock(&curSymArena->lock);
+    }
+    curProfile->mark = ProfileClock();
+}
+
+/* Count the nodes of a parse tree by label */
+static void ProfileTree(NODE* head){
+    for (NODE* n = head; n != NULL; n = n->next) {
+        const char* colon = strchr(n->name, ':');
+        int len = colon ? (int)(colon - n->name) : (int)strlen(n->name);
+        if (len >= (int)sizeof(curProfile->label[0].label)) len = sizeof(curProfile->label[0].label) - 1;
+        int i = 0;
+        while (i < curProfile->num_label
+               && (curProfile->label[i].len != len || memcmp(curProfile->label[i].label, n->name, len))) i++;
+        if (i == curProfile->num_label && i < PROFILE_MAX_LABEL) {
+            memcpy(curProfile->label[i].label, n->name, len);
+            curProfile->label[i].len = len;
+            curProfile->num_label++;
+        }
+        if (i < curProfile->num_label) curProfile->label[i].count++;
+        curProfile->numNode++;
+        ProfileTree(n->child);
+    }
+}
+
+static void ProfileSymTab(SYMTAB* symtab){
+    curProfile->numScope++;
+    curProfile->numSymbol += symtab->num_entry;
+    for (int i = 0; i < symtab->num_child; i++) ProfileSymTab(symtab->child[i]);
+}
+
+static void ProfileStrings(INTERNTAB* strings){
+    curProfile->numString = strings->num_item;
+    for (INTERNBLOCK* b = strings->blocks; b != NULL; b = b->next) {
+        curProfile->stringBytes += b->used;
+        curProfile->stringBlocks++;
+    }
+}
+
+static int CompareLabelCount(const void* a, const void* b){
+    return ((const LABELSTAT*)b)->count - ((const LABELSTAT*)a)->count;
+}
+
+static void PrintJsonString(FILE* out, const char* s, int len){
+    fputc('"', out);
+    for (int i = 0; i < len; i++) {
+        if (s[i] == '"' || s[i] == '\\') fputc('\\', out);
+        if ((unsigned char)s[i] < 0x20) fprintf(out, "\\u%04x", s[i]);
+        else fputc(s[i], out);
+    }
+    fputc('"', out);
+}
+
+/* Report a finished profile, as text or as one JSON object per line */
+static void PrintProfile(PROFILE* prof, const char* path, int format, FILE* out){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);     // peak RSS는 process 전체 기준 (Linux에서는 KB)
+    int arenaBlocks = 0;
+    for (int i = 0; i < prof->num_phase; i++) {
+        if (prof->phase[i].arenaBlocks > arenaBlocks) arenaBlocks = prof->phase[i].arenaBlocks;
+    }
+    qsort(prof->label, prof->num_label, sizeof(LABELSTAT), CompareLabelCount);
+
+    if (format == PROFILE_JSON) {
+        fprintf(out, "{\"file\":");
+        PrintJsonString(out, path, (int)strlen(path));
+        fprintf(out, ",\"phases\":[");
+        for (int i = 0; i < prof->num_phase; i++) {
+            PHASESTAT* ph = &prof->phase[i];
+            fprintf(out, "%s{\"name\":\"%s\",\"ms\":%.3f,\"arena_bytes\":%zu,\"arena_blocks\":%d}",
+                    i ? "," : "", ph->name, ph->ms, ph->arenaBytes, ph->arenaBlocks);
+        }
+        fprintf(out, "],\"lex_ms\":%.3f,\"tokens\":%ld,\"nodes\":%d,\"scopes\":%d,\"symbols\":%d,"
+                     "\"strings\":%d,\"string_bytes\":%zu,\"allocs\":{\"nodes\":%d,\"arena_blocks\":%d,"
+                     "\"string_blocks\":%d},\"peak_rss_kb\":%ld,\"labels\":{",
+                prof->lexMs, prof->numToken, prof->numNode, prof->numScope, prof->numSymbol,
+                prof->numString, prof->stringBytes, prof->numNode, arenaBlocks, prof->stringBlocks,
+                usage.ru_maxrss);
+        for (int i = 0; i < prof->num_label; i++) {
+            if (i) fputc(',', out);
+            PrintJsonString(out, prof->label[i].label, prof->label[i].len);
+            fprintf(out, ":%d", prof->label[i].count);
+        }
+        fprintf(out, "}}\n");
+        return;
+    }
+
+    fprintf(out, "==profile== %s\n", path);
+    fprintf(out, "%-10s %10s %12s %8s\n", "phase", "ms", "arena bytes", "blocks");
+    for (int i = 0; i < prof->num_phase; i++) {
+        PHASESTAT* ph = &prof->phase[i];
+        fprintf(out, "%-10s %10.3f %12zu %8d\n", ph->name, ph->ms, ph->arenaBytes, ph->arenaBlocks);
+    }
+    fprintf(out, "lexer      %10.3f ms in parse, %ld tokens\n", prof->lexMs, prof->numToken);
+    fprintf(out, "nodes %d, scopes %d, symbols %d, strings %d (%zu bytes)\n",
+            prof->numNode, prof->numScope, prof->numSymbol, prof->numString, prof->stringBytes);
+    fprintf(out, "allocations: %d nodes, %d arena blocks, %d string blocks; peak RSS %ld KB\n",
+            prof->numNode, arenaBlocks, prof->stringBlocks, usage.ru_maxrss);
+    fprintf(out, "nodes by label:");
+    for (int i = 0; i < prof->num_label; i++) {
+        fprintf(out, " %.*s %d", prof->label[i].len, prof->label[i].label, prof->label[i].count);
+    }
+    fprintf(out, "\n");
+}
+
+static int DispatchLex(YYSTYPE* lval, yyscan_t scanner, PARSECTX* ctx){
+    // --profile일 때만 token마다 시간을 잰다
+    double start = curProfile ? ProfileClock() : 0;
+    int token = ctx->fast != NULL ? FastLex(ctx->fast, lval) : yylex(lval, scanner);
+    if (curProfile != NULL) {
+        curProfile->lexMs += ProfileClock() - start;
+        curProfile->numToken++;
+    }
+    return token;
+}
+
+void yyerror(yyscan_t scanner, PARSECTX* ctx, const char *str){
+    int line = ctx->fast ? ctx->fast->lineno : yyget_lineno(scanner);
+    const char* text = ctx->fast ? ctx->fast->text : yyget_text(scanner);
+    fprintf(ctx->err, "%s:%d: error: %s '%s' token \n", ctx->filename, line, str, text);
+}
+
 NODE* CreateTokenNode(char* token_type, char* token_value) {
-    NODE* node = MakeNode(token_type);
+    // "TYPE: lexeme" label도 intern해서 같은 token끼리 하나를 같이 쓴다
+    size_t len = strlen(token_type) + 2 + strlen(token_value);
+    char small[128];
+    char* buf = len < sizeof(small) ? small : (char*)malloc(len + 1);
     sprintf(buf, "%s: %s", token_type, token_value);
-    //free(node->name);
-    //node->name = strdup(buf);
-    strcpy(node->name, buf);
+    NODE* node = MakeNode(Intern(buf, len));
+    if (buf != small) free(buf);
     return node;
 }
 
@@ -575,66 +874,790 @@ NODE* BuildRuleNode(char* rulename, SymbolSpec* specs, int count) {
 	return parent;
 }
 
-int main(int argc, char **argv){
-    if (argc < 2){
-        fprintf(stderr, "usage: %s <source.c>\n", argv[0]);
-        return 1;
-    }
-    yyin = fopen(argv[1], "r");
-    if (!yyin){
-        fprintf(stderr, "cannot open %s\n", argv[1]);
-        return 1;
-    }
-    
-    filename = argv[1];
-    //todo
-    SYMTAB* rootSymTab = NewSymTab();
-    char* scopeErrorIds[MAX_SCOPE_ERRORS];
-    int scopeErrorCount = 0;
+/* =====DRIVER===== */
+/* Options that apply to every input file */
+typedef struct ANALYSISOPT {
+    bool threePass;         /* --three-pass */
+    bool fastLex;           /* --fast-lex: hand-written lexer for mapped files */
+    bool emitSymTab;        /* --emit-symtab: save each file's symbol table as <source>.stb */
+    int  profile;           /* --profile: PROFILE_TEXT or PROFILE_JSON, 0 = off */
+    int  numThreads;        /* > 0: analyze the function bodies of a file on this many threads */
+    SYMTAB* imports;        /* --import: loaded tables, searched after the file's global scope */
+} ANALYSISOPT;
 
-    char* typeErrorIds[MAX_TYPE_ERRORS];
-    int typeErrorCount = 0; 
+/* Parse len bytes of source that start at the given line. Syntax errors go to err.
+   The tree's strings live in strings, which must outlive it. */
+static NODE* ParseBytes(const char* path, const char* text, int len, int line, INTERNTAB* strings, FILE* err){
+    PARSECTX ctx = { path, NULL, err, NULL };
+    INTERNTAB* prevStrings = UseInternTab(strings);
+    yyscan_t scanner;
+    yylex_init_extra(strings, &scanner);
+    yy_scan_bytes(text, len, scanner);
+    yyset_lineno(line, scanner);
+    yyparse(scanner, &ctx);
+    yylex_destroy(scanner);
+    UseInternTab(prevStrings);
+    return ctx.head;
+}
+
+/* Build the symbol table of a parsed file, run the analyses and print the report.
+   path names the source for --emit-symtab (NULL: do not save the table). */
+static void ReportTree(NODE* head, const ANALYSISOPT* opt, const char* path, FILE* out, FILE* err){
+    // 파일마다 arena를 따로 써서 끝나면 통째로 버린다
+    SYMARENA arena = SYMARENA_INIT;
+    SYMARENA* prevArena = UseSymArena(&arena);
+
+    SYMTAB* rootSymTab = NewSymTab();
+    rootSymTab->parent = opt->imports;      // global scope에 없는 이름은 import된 table에서 찾는다
+    CHECKLIST checks = { NULL, 0, 0 };
+    DIAGLIST scopeErrors = { 0 };
+    DIAGLIST typeErrors = { 0 };
 
-    yyparse();
-    //todo
-    
     if (head != NULL) { 
-        ConstructSymTab(rootSymTab, head);
-        
-        printf("--------------------------------------------------------\n");
-        PrintSymTab(rootSymTab);
-        printf("\n"); 
-
-        ResetVisitCounters(rootSymTab);
-        ScopeAnalysis(rootSymTab, head, scopeErrorIds, &scopeErrorCount);
-        if (scopeErrorCount > 0) {
-            for (int i = 0; i < scopeErrorCount; i++) {
-                printf("Undefined Error (%s)\n", scopeErrorIds[i]);
-            }
+        if (opt->numThreads > 0) ParallelAnalysis(rootSymTab, head, opt->numThreads, &scopeErrors, &typeErrors);
+        else if (opt->threePass) ConstructSymTab(rootSymTab, head);
+        else FusedAnalysis(rootSymTab, head, &checks);
+        ProfilePhase(opt->numThreads > 0 ? "parallel" : "symtab");
+        // 숫자와 #define만으로 된 al_expr은 분석 전에 값 하나로 접는다 (-j에서는 function마다 worker가)
+        if (opt->threePass) {
+            ResetVisitCounters(rootSymTab);
+            FoldConstants(rootSymTab, head);
+        } else if (opt->numThreads <= 0) {
+            FoldChecks(&checks);
         }
+        ProfilePhase("fold");
 
-        if (scopeErrorCount == 0){
+        if (opt->emitSymTab && path != NULL && strcmp(path, "-")) {
+            char* stbPath = (char*)malloc(strlen(path) + 5);
+            sprintf(stbPath, "%s.stb", path);
+            if (!WriteSymTab(rootSymTab, stbPath)) fprintf(err, "cannot write %s\n", stbPath);
+            free(stbPath);
+        }
+        
+        fprintf(out, "--------------------------------------------------------\n");
+        FPrintSymTab(out, rootSymTab);
+        fprintf(out, "\n"); 
+        ProfilePhase("output");
+
+        if (opt->threePass) {
             ResetVisitCounters(rootSymTab);
-            TypeAnalysis(rootSymTab, head, typeErrorIds, &typeErrorCount);
-            for (int i = 0; i < typeErrorCount; i++) {
-                    bool duplicate = false;
-                    for (int j = 0; j < i; j++) {
-                        if (strcmp(typeErrorIds[i], typeErrorIds[j]) == 0) {
-                            duplicate = true;
-                            break;
-                        }
-                    }
-                    if (!duplicate) {
-                        printf("%s\n", typeErrorIds[i]);
-                    }
-                }
-                for (int i = 0; i < typeErrorCount; i++) {
-                    free(typeErrorIds[i]);
+            ScopeAnalysis(rootSymTab, head, &scopeErrors);
+        } else if (opt->numThreads <= 0) {
+            ResolveScopeChecks(&checks, &scopeErrors);
+        }
+        ProfilePhase("scope");
+        for (int i = 0; i < scopeErrors.num_item; i++) {
+            fprintf(out, "Undefined Error (%s)\n", scopeErrors.item[i]);
+        }
+
+        if (scopeErrors.num_item == 0){
+            if (opt->threePass) {
+                ResetVisitCounters(rootSymTab);
+                TypeAnalysis(rootSymTab, head, &typeErrors);
+            } else if (opt->numThreads <= 0) {
+                ResolveTypeChecks(&checks, &typeErrors);
+            }
+            ProfilePhase("type");
+            // 중복은 AddDiag에서 이미 걸러졌고, 처음 발견된 순서 그대로 출력
+            for (int i = 0; i < typeErrors.num_item; i++) {
+                fprintf(out, "%s\n", typeErrors.item[i]);
             }
         }
         
+        ProfilePhase("output");
+        if (curProfile != NULL) ProfileSymTab(rootSymTab);
     } else {
-        fprintf(stderr, "Parsing failed. No syntax tree generated.\n");
+        fprintf(err, "Parsing failed. No syntax tree generated.\n");
     } 
+    FreeDiagList(&scopeErrors);
+    FreeDiagList(&typeErrors);
+    FreeCheckList(&checks);
+    FreeSymArena();
+    UseSymArena(prevArena);
+}
+
+/* Parse and analyze one file ("-" is stdin). The report goes to out, diagnostics to err.
+   Returns nonzero if the file could not be opened. */
+static int AnalyzeFile(const char* path, const ANALYSISOPT* opt, FILE* out, FILE* err){
+    PROFILE prof;
+    PROFILE* prevProfile = UseProfile(opt->profile ? StartProfile(&prof) : NULL);
+
+    // regular file는 mmap해서 flex가 그 위를 바로 읽게 하고, stdin/pipe는 예전처럼 FILE*로
+    MAPPEDFILE map = { NULL, 0, 0 };
+    FILE* in = NULL;
+    if (!MapSourceFile(path, &map)) {
+        in = strcmp(path, "-") ? fopen(path, "r") : stdin;
+        if (!in){
+            fprintf(err, "cannot open %s\n", path);
+            UseProfile(prevProfile);
+            return 1;
+        }
+    }
+    ProfilePhase("read");
+
+    PARSECTX ctx = { path, NULL, err, NULL };
+    INTERNTAB strings = { 0 };
+    INTERNTAB* prevStrings = UseInternTab(&strings);
+    FASTLEX fast;
+    yyscan_t scanner;
+    yylex_init_extra(&strings, &scanner);
+    if (map.data != NULL && opt->fastLex) {
+        FastLexInit(&fast, map.data, map.len, &strings);
+        ctx.fast = &fast;
+    } else if (map.data != NULL) {
+        yy_scan_buffer(map.data, map.len + 2, scanner);
+        yyset_lineno(1, scanner);   // yy_scan_buffer는 line number를 초기화하지 않는다
+    } else {
+        yyset_in(in, scanner);
+    }
+    yyparse(scanner, &ctx);
+    yylex_destroy(scanner);
+    UseInternTab(prevStrings);
+    if (in != NULL && in != stdin) fclose(in);
+    UnmapSourceFile(&map);      // tree의 문자열은 intern되어 있어서 원문은 더 필요 없다
+    ProfilePhase("parse");
+    if (curProfile != NULL) {
+        ProfileTree(ctx.head);
+        ProfileStrings(&strings);
+    }
+
+    ReportTree(ctx.head, opt, path, out, err);
+    FreeTree(ctx.head);
+    FreeInternTab(&strings);
+    ProfilePhase("free");
+    if (curProfile != NULL) PrintProfile(curProfile, path, opt->profile, err);
+    UseProfile(prevProfile);
     return 0;
 }
+
+/* List of input paths, in the order they are reported */
+typedef struct PATHLIST {
+    char** item;
+    int num_item;
+    int max_item;
+} PATHLIST;
+
+static void AddPath(PATHLIST* list, const char* path){
+    if (list->num_item == list->max_item) {
+        list->max_item = list->max_item ? list->max_item * 2 : 16;
+        list->item = (char**)realloc(list->item, sizeof(char*) * list->max_item);
+    }
+    list->item[list->num_item++] = strdup(path);
+}
+
+static int ComparePath(const void* a, const void* b){
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static bool HasSuffix(const char* str, const char* suffix){
+    size_t n = strlen(str), m = strlen(suffix);
+    return n >= m && !strcmp(str + n - m, suffix);
+}
+
+/* Add every *.c file under dir, recursing into subdirectories in name order */
+static void CollectDir(PATHLIST* list, const char* dir){
+    DIR* d = opendir(dir);
+    if (!d) return;
+
+    PATHLIST entries = { NULL, 0, 0 };
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        char* path = (char*)malloc(strlen(dir) + strlen(ent->d_name) + 2);
+        sprintf(path, "%s/%s", dir, ent->d_name);
+        AddPath(&entries, path);
+        free(path);
+    }
+    closedir(d);
+    qsort(entries.item, entries.num_item, sizeof(char*), ComparePath);
+
+    for (int i = 0; i < entries.num_item; i++) {
+        struct stat st;
+        if (stat(entries.item[i], &st) == 0) {
+            if (S_ISDIR(st.st_mode)) CollectDir(list, entries.item[i]);
+            else if (S_ISREG(st.st_mode) && HasSuffix(entries.item[i], ".c")) AddPath(list, entries.item[i]);
+        }
+        free(entries.item[i]);
+    }
+    free(entries.item);
+}
+
+/* An argument is a source file, a directory, or @listfile (one path per line) */
+static void CollectInputs(PATHLIST* list, const char* arg){
+    if (arg[0] == '@') {
+        FILE* fp = fopen(arg + 1, "r");
+        if (!fp) {
+            AddPath(list, arg + 1);     // 여는 건 AnalyzeFile에서 다시 실패하면서 에러 출력
+            return;
+        }
+        char line[4096];
+        while (fgets(line, sizeof(line), fp)) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] != '\0') CollectInputs(list, line);
+        }
+        fclose(fp);
+        return;
+    }
+    struct stat st;
+    if (stat(arg, &st) == 0 && S_ISDIR(st.st_mode)) CollectDir(list, arg);
+    else AddPath(list, arg);
+}
+
+/* One input file of a multi-file run; its output is buffered until every file is done */
+typedef struct FILETASK {
+    const char* path;
+    char* out;
+    size_t outLen;
+    char* err;
+    size_t errLen;
+    int status;
+} FILETASK;
+
+typedef struct FILEJOB {
+    FILETASK* tasks;
+    const ANALYSISOPT* opt;
+} FILEJOB;
+
+static void AnalyzeFileTask(int index, void* arg){
+    FILEJOB* job = (FILEJOB*)arg;
+    FILETASK* task = &job->tasks[index];
+    FILE* out = open_memstream(&task->out, &task->outLen);
+    FILE* err = open_memstream(&task->err, &task->errLen);
+    task->status = AnalyzeFile(task->path, job->opt, out, err);
+    fclose(out);
+    fclose(err);
+}
+
+/* =====LEXER SELF-CHECK===== */
+/* --diff-lexer: run flex and the hand-written lexer side by side over a file
+   and report the first token (kind, lexeme or line) where they disagree.
+   Characters echoed by either lexer are compared as well. */
+static const char* TokenName(int token){
+    return token == 0 ? "end of file" : yytname[YYTRANSLATE(token)];
+}
+
+static int DiffLexers(const char* path){
+    MAPPEDFILE map = { NULL, 0, 0 };
+    if (!MapSourceFile(path, &map)) {
+        fprintf(stderr, "cannot map %s (--diff-lexer needs a regular, non-empty file)\n", path);
+        return 2;
+    }
+    INTERNTAB strings = { 0 };
+    char* flexEcho = NULL;
+    char* fastEcho = NULL;
+    size_t flexEchoLen = 0, fastEchoLen = 0;
+    FILE* flexOut = open_memstream(&flexEcho, &flexEchoLen);
+    FILE* fastOut = open_memstream(&fastEcho, &fastEchoLen);
+
+    // flex는 scan 중에 buffer에 쓰기 때문에 복사본(yy_scan_bytes)을 읽게 한다
+    yyscan_t scanner;
+    yylex_init_extra(&strings, &scanner);
+    yyset_out(flexOut, scanner);
+    yy_scan_bytes(map.data, (int)map.len, scanner);
+    yyset_lineno(1, scanner);       // FastLexInit처럼 1부터
+    FASTLEX fast;
+    FastLexInit(&fast, map.data, map.len, &strings);
+    fast.echo = fastOut;
+
+    int status = 0;
+    int count = 0;
+    for (;;) {
+        YYSTYPE a, b;
+        int ta = yylex(&a, scanner);
+        int tb = FastLex(&fast, &b);
+        int la = yyget_lineno(scanner);
+        const char* sa = ta ? a.string : "";
+        const char* sb = tb ? b.string : "";
+        // 같은 table에 intern되므로 lexeme은 pointer만 비교하면 된다
+        if (ta != tb || sa != sb || la != fast.lineno) {
+            printf("lexers differ at token %d: flex %s '%s' (line %d), fast %s '%s' (line %d)\n",
+                   count + 1, TokenName(ta), sa, la, TokenName(tb), sb, fast.lineno);
+            status = 1;
+            break;
+        }
+        if (ta == 0) break;
+        count++;
+    }
+    fclose(flexOut);
+    fclose(fastOut);
+    if (status == 0 && (flexEchoLen != fastEchoLen || memcmp(flexEcho, fastEcho, flexEchoLen))) {
+        printf("lexers echo different unmatched characters\n");
+        status = 1;
+    }
+    if (status == 0) {
+        printf("File %s: %d tokens, flex and the hand-written lexer agree\n", path, count);
+    }
+
+    yylex_destroy(scanner);
+    free(flexEcho);
+    free(fastEcho);
+    FreeInternTab(&strings);
+    UnmapSourceFile(&map);
+    return status;
+}
+
+/* =====DAEMON===== */
+/*  --daemon keeps checked files resident between requests, for editors that
+    re-check on every save. One request per line on stdin:
+        check <path>    print the report of path (diagnostics included), then "%%done <status>"
+        forget <path>   drop everything cached for path
+        quit
+    The report is the same as a one-file run with stderr merged into stdout.
+    A file is split into its top-level define_header / func_def segments and
+    each one is parsed on its own. Unchanged files are answered from cache,
+    only segments whose text changed are re-parsed, and a func_def is
+    re-analyzed only when its text or the global signature (defines and
+    function headers) changed. Text that does not split cleanly, or has
+    syntax errors, is parsed and analyzed whole as usual. */
+
+typedef struct SEGMENT {
+    unsigned int hash;          /* HashBytes of the segment text */
+    unsigned int sigHash;       /* hash of the part other functions can see (define / function header) */
+    bool         isFunc;
+    NODE*        tree;          /* c_code parsed from this segment alone */
+    INTERNTAB    strings;       /* lexemes and labels of tree */
+    unsigned int globalHash;    /* global signature task was analyzed under */
+    SYMARENA     arena;         /* func_def: owns task.scope and everything below it */
+    FUNCTASK     task;          /* func_def: cached scope and diagnostics, task.scope == NULL until analyzed */
+} SEGMENT;
+
+typedef struct SOURCEFILE {
+    char*        path;
+    unsigned int hash;          /* HashBytes of the whole file at the last check */
+    char*        report;        /* output of the last check, NULL if none */
+    size_t       reportLen;
+    SEGMENT**    seg;
+    int          num_seg;
+} SOURCEFILE;
+
+typedef struct SOURCELIST {
+    SOURCEFILE** item;
+    int num_item;
+    int max_item;
+} SOURCELIST;
+
+static void FreeSegment(SEGMENT* seg){
+    SYMARENA* prevArena = UseSymArena(&seg->arena);
+    FreeSymArena();
+    UseSymArena(prevArena);
+    FreeDiagList(&seg->task.scopeErrors);
+    FreeDiagList(&seg->task.typeErrors);
+    FreeTree(seg->tree);
+    FreeInternTab(&seg->strings);
+    free(seg);
+}
+
+static void FreeSourceFile(SOURCEFILE* file){
+    for (int i = 0; i < file->num_seg; i++) {
+        FreeSegment(file->seg[i]);
+    }
+    free(file->seg);
+    free(file->report);
+    free(file->path);
+    free(file);
+}
+
+/* Skip blanks and comments; returns the new position and advances *line */
+static int SkipSpace(const char* text, int len, int i, int* line){
+    while (i < len) {
+        if (text[i] == '\n') {
+            (*line)++;
+            i++;
+        } else if (text[i] == ' ' || text[i] == '\t' || text[i] == '\r') {
+            i++;
+        } else if (i + 1 < len && text[i] == '/' && text[i + 1] == '/') {
+            while (i < len && text[i] != '\n') i++;
+        } else if (i + 1 < len && text[i] == '/' && text[i + 1] == '*') {
+            i += 2;
+            while (i < len && !(text[i] == '*' && i + 1 < len && text[i + 1] == '/')) {
+                if (text[i] == '\n') (*line)++;
+                i++;
+            }
+            i += 2;
+        } else {
+            break;
+        }
+    }
+    return i < len ? i : len;
+}
+
+/* Length of the next top-level segment starting at i: a #define line, or a
+   function up to the brace that closes its body. 0 if the text does not split. */
+static int SegmentLength(const char* text, int len, int i, int* header, int* line){
+    int start = i;
+    if (len - i >= 7 && !strncmp(text + i, "#define", 7)) {
+        while (i < len && text[i] != '\n') i++;
+        *header = i - start;
+        return i - start;
+    }
+    int depth = 0;
+    *header = 0;
+    while (i < len) {
+        int next = SkipSpace(text, len, i, line);
+        if (next != i) {
+            i = next;
+            continue;
+        }
+        if (text[i] == '{') {
+            if (*header == 0) *header = i - start;
+            depth++;
+        } else if (text[i] == '}') {
+            if (--depth < 0) return 0;
+            if (depth == 0) return i + 1 - start;
+        } else if (text[i] == ';' && depth == 0) {
+            return 0;       // top-level 선언은 문법에 없으니 통째로 parse해서 에러를 내게 한다
+        }
+        i++;
+    }
+    return 0;
+}
+
+/* Re-split the file into segments, reusing every segment whose text is unchanged.
+   Returns false (and leaves the cache as it was) if the text does not split into
+   segments that each parse cleanly into a single code node. */
+static bool UpdateSegments(SOURCEFILE* file, const char* text, int len){
+    SEGMENT** seg = NULL;
+    int numSeg = 0, maxSeg = 0;
+    bool* reused = (bool*)calloc(file->num_seg > 0 ? file->num_seg : 1, sizeof(bool));
+    bool ok = true;
+
+    int line = 1;
+    int i = SkipSpace(text, len, 0, &line);
+    while (ok && i < len) {
+        int startLine = line, header;
+        int segLen = SegmentLength(text, len, i, &header, &line);
+        if (segLen == 0) {
+            ok = false;
+            break;
+        }
+        unsigned int hash = HashBytes(text + i, segLen);
+
+        SEGMENT* cur = NULL;
+        for (int k = 0; k < file->num_seg; k++) {
+            if (!reused[k] && file->seg[k]->hash == hash) {
+                reused[k] = true;
+                cur = file->seg[k];
+                break;
+            }
+        }
+        if (cur == NULL) {
+            char* errBuf = NULL;
+            size_t errLen = 0;
+            FILE* err = open_memstream(&errBuf, &errLen);
+            INTERNTAB strings = { 0 };
+            NODE* tree = ParseBytes(file->path, text + i, segLen, startLine, &strings, err);
+            fclose(err);
+            free(errBuf);
+            // 에러 없이 code 하나로만 parse된 경우만 segment로 쓴다
+            if (errLen != 0 || tree == NULL || tree->child == NULL
+                || strcmp(tree->child->name, "code") || tree->child->next != NULL) {
+                FreeTree(tree);
+                FreeInternTab(&strings);
+                ok = false;
+                break;
+            }
+            cur = (SEGMENT*)calloc(1, sizeof(SEGMENT));
+            cur->hash = hash;
+            cur->tree = tree;
+            cur->strings = strings;
+            cur->isFunc = !strcmp(tree->child->child->name, T_FUNC_DEF);
+            cur->arena = (SYMARENA)SYMARENA_INIT;
+            cur->task.arena = &cur->arena;
+            if (cur->isFunc) cur->task.funcDef = tree->child->child;
+        }
+        cur->sigHash = HashBytes(text + i, header);
+
+        if (numSeg == maxSeg) {
+            maxSeg = maxSeg ? maxSeg * 2 : 16;
+            seg = (SEGMENT**)realloc(seg, sizeof(SEGMENT*) * maxSeg);
+        }
+        seg[numSeg++] = cur;
+        i = SkipSpace(text, len, i + segLen, &line);
+    }
+
+    if (ok) {
+        for (int k = 0; k < file->num_seg; k++) {
+            if (!reused[k]) FreeSegment(file->seg[k]);
+        }
+        free(file->seg);
+        file->seg = seg;
+        file->num_seg = numSeg;
+    } else {
+        // 새로 parse한 segment만 버리고 cache는 그대로 둔다
+        for (int k = 0; k < numSeg; k++) {
+            bool old = false;
+            for (int m = 0; m < file->num_seg && !old; m++) old = (file->seg[m] == seg[k]);
+            if (!old) FreeSegment(seg[k]);
+        }
+        free(seg);
+    }
+    free(reused);
+    return ok;
+}
+
+/* Analyze the segmented file, re-analyzing only the func_defs whose cache is stale */
+static void ReportSegments(SOURCEFILE* file, const ANALYSISOPT* opt, FILE* out){
+    SYMARENA arena = SYMARENA_INIT;
+    SYMARENA* prevArena = UseSymArena(&arena);
+    SYMTAB* rootSymTab = NewSymTab();
+    rootSymTab->parent = opt->imports;
+    DIAGLIST scopeErrors = { 0 };
+    DIAGLIST typeErrors = { 0 };
+
+    unsigned int globalHash = 2166136261u;
+    for (int i = 0; i < file->num_seg; i++) {
+        globalHash = (globalHash ^ file->seg[i]->sigHash) * 16777619u;
+    }
+
+    // ParallelAnalysis와 같은 순서: 1. define, function symbol, parameter로 global scope를 먼저 다 채운다
+    bool* stale = (bool*)calloc(file->num_seg > 0 ? file->num_seg : 1, sizeof(bool));
+    for (int i = 0; i < file->num_seg; i++) {
+        SEGMENT* seg = file->seg[i];
+        if (!seg->isFunc) {
+            DeclareNode(rootSymTab, seg->tree->child->child);
+            continue;
+        }
+        stale[i] = seg->task.scope == NULL || seg->globalHash != globalHash;
+        if (!stale[i]) {
+            // body scope는 cache된 것으로 바꿔 낀다
+            DeclareNode(rootSymTab, seg->task.funcDef);
+            rootSymTab->child[rootSymTab->num_child - 1] = seg->task.scope;
+            seg->task.scope->parent = rootSymTab;
+        } else {
+            // body scope는 segment의 arena에 만들어서 다음 check까지 살려 둔다
+            UseSymArena(&seg->arena);
+            FreeSymArena();
+            FreeDiagList(&seg->task.scopeErrors);
+            FreeDiagList(&seg->task.typeErrors);
+            ClearExprTypes(seg->task.funcDef);
+            seg->task.scope = DeclareNode(rootSymTab, seg->task.funcDef);
+            seg->globalHash = globalHash;
+            UseSymArena(&arena);
+        }
+    }
+
+    // 2. global이 다 보이는 상태에서 stale한 function body만 다시 분석
+    for (int i = 0; i < file->num_seg; i++) {
+        SEGMENT* seg = file->seg[i];
+        if (!seg->isFunc) continue;
+        if (stale[i]) AnalyzeFunction(0, &seg->task);
+        for (int j = 0; j < seg->task.scopeErrors.num_item; j++) AddDiag(&scopeErrors, seg->task.scopeErrors.item[j]);
+        for (int j = 0; j < seg->task.typeErrors.num_item; j++) AddDiag(&typeErrors, seg->task.typeErrors.item[j]);
+    }
+    free(stale);
+
+    fprintf(out, "--------------------------------------------------------\n");
+    FPrintSymTab(out, rootSymTab);
+    fprintf(out, "\n");
+    for (int i = 0; i < scopeErrors.num_item; i++) {
+        fprintf(out, "Undefined Error (%s)\n", scopeErrors.item[i]);
+    }
+    if (scopeErrors.num_item == 0) {
+        for (int i = 0; i < typeErrors.num_item; i++) {
+            fprintf(out, "%s\n", typeErrors.item[i]);
+        }
+    }
+    FreeDiagList(&scopeErrors);
+    FreeDiagList(&typeErrors);
+    FreeSymArena();
+    UseSymArena(prevArena);
+}
+
+static char* ReadWholeFile(const char* path, size_t* len){
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return NULL;
+    size_t cap = 65536;
+    char* data = (char*)malloc(cap);
+    *len = 0;
+    size_t n;
+    while ((n = fread(data + *len, 1, cap - *len, fp)) > 0) {
+        *len += n;
+        if (*len == cap) {
+            cap *= 2;
+            data = (char*)realloc(data, cap);
+        }
+    }
+    fclose(fp);
+    return data;
+}
+
+/* Answer one check request. Returns nonzero if the file could not be read. */
+static int CheckSourceFile(SOURCEFILE* file, const ANALYSISOPT* opt, FILE* out){
+    MAPPEDFILE map = { NULL, 0, 0 };
+    size_t len = 0;
+    char* text = MapSourceFile(file->path, &map) ? map.data : ReadWholeFile(file->path, &len);
+    if (map.data != NULL) len = map.len;
+    if (text == NULL) {
+        fprintf(out, "cannot open %s\n", file->path);
+        return 1;
+    }
+
+    unsigned int hash = HashBytes(text, len);
+    if (file->report == NULL || file->hash != hash) {
+        free(file->report);
+        FILE* rep = open_memstream(&file->report, &file->reportLen);
+        if (UpdateSegments(file, text, (int)len)) {
+            ReportSegments(file, opt, rep);
+        } else {
+            INTERNTAB strings = { 0 };
+            NODE* head = ParseBytes(file->path, text, (int)len, 1, &strings, rep);
+            ReportTree(head, opt, NULL, rep, rep);
+            FreeTree(head);
+            FreeInternTab(&strings);
+        }
+        fclose(rep);
+        file->hash = hash;
+    }
+    fwrite(file->report, 1, file->reportLen, out);
+    if (map.data != NULL) UnmapSourceFile(&map);
+    else free(text);
+    return 0;
+}
+
+static SOURCEFILE* FindSourceFile(SOURCELIST* list, const char* path, bool create){
+    for (int i = 0; i < list->num_item; i++) {
+        if (!strcmp(list->item[i]->path, path)) return list->item[i];
+    }
+    if (!create) return NULL;
+    if (list->num_item == list->max_item) {
+        list->max_item = list->max_item ? list->max_item * 2 : 16;
+        list->item = (SOURCEFILE**)realloc(list->item, sizeof(SOURCEFILE*) * list->max_item);
+    }
+    SOURCEFILE* file = (SOURCEFILE*)calloc(1, sizeof(SOURCEFILE));
+    file->path = strdup(path);
+    list->item[list->num_item++] = file;
+    return file;
+}
+
+static int RunDaemon(const ANALYSISOPT* opt){
+    SOURCELIST files = { NULL, 0, 0 };
+    char line[4096];
+    while (fgets(line, sizeof(line), stdin)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (!strncmp(line, "check ", 6)) {
+            int status = CheckSourceFile(FindSourceFile(&files, line + 6, true), opt, stdout);
+            printf("%%%%done %d\n", status);
+        } else if (!strncmp(line, "forget ", 7)) {
+            SOURCEFILE* file = FindSourceFile(&files, line + 7, false);
+            if (file != NULL) {
+                for (int i = 0; i < files.num_item; i++) {
+                    if (files.item[i] == file) files.item[i] = files.item[--files.num_item];
+                }
+                FreeSourceFile(file);
+            }
+            printf("%%%%done 0\n");
+        } else if (!strcmp(line, "quit")) {
+            break;
+        } else if (line[0] != '\0') {
+            printf("%%%%error unknown request: %s\n", line);
+        }
+        fflush(stdout);
+    }
+    for (int i = 0; i < files.num_item; i++) {
+        FreeSourceFile(files.item[i]);
+    }
+    free(files.item);
+    return 0;
+}
+
+int main(int argc, char **argv){
+    // --three-pass: ConstructSymTab / ScopeAnalysis / TypeAnalysis를 따로따로 도는 예전 방식
+    // --fast-lex: flex 대신 fastlex.h의 lexer로 (mmap된 file만), --diff-lexer: 두 lexer 결과 비교
+    // --daemon: stdin으로 check 요청을 받아 바뀐 부분만 다시 분석 (editor 연동용)
+    // --profile[=json]: 파일마다 phase별 시간, node/symbol 수, 메모리를 stderr로 (json은 한 줄에 파일 하나)
+    // --emit-symtab: 각 파일의 symbol table을 <source>.stb로 저장, --import x.stb: 저장된 table의 global을 가져다 씀 (여러 번 가능)
+    // -j N: 파일이 하나면 function body들을, 여러 개면 파일들을 N개 thread로 나눠서 분석 (0이면 core 수)
+    ANALYSISOPT opt = { false, false, false, 0, -1, NULL };
+    int numThreads = -1;
+    bool daemon = false;
+    SYMARENA importArena = SYMARENA_INIT;
+    SYMTABIMAGE* images = NULL;
+    int numImage = 0;
+    int argi = 1;
+    while (argi < argc && argv[argi][0] == '-') {
+        if (!strcmp(argv[argi], "--three-pass")) {
+            opt.threePass = true;
+        } else if (!strcmp(argv[argi], "--fast-lex")) {
+            opt.fastLex = true;
+        } else if (!strcmp(argv[argi], "--diff-lexer") && argi + 1 < argc) {
+            return DiffLexers(argv[argi + 1]);
+        } else if (!strcmp(argv[argi], "--profile")) {
+            opt.profile = PROFILE_TEXT;
+        } else if (!strcmp(argv[argi], "--profile=json")) {
+            opt.profile = PROFILE_JSON;
+        } else if (!strcmp(argv[argi], "--emit-symtab")) {
+            opt.emitSymTab = true;
+        } else if (!strcmp(argv[argi], "--import") && argi + 1 < argc) {
+            // 먼저 준 import가 먼저 검색되도록 뒤에 load한 table을 chain 끝에 붙인다
+            images = (SYMTABIMAGE*)realloc(images, (numImage + 1) * sizeof(SYMTABIMAGE));
+            SYMARENA* prevArena = UseSymArena(&importArena);
+            SYMTAB* table = LoadSymTab(argv[++argi], &images[numImage]);
+            UseSymArena(prevArena);
+            if (table == NULL) return 1;
+            numImage++;
+            SYMTAB** last = &opt.imports;
+            while (*last != NULL) last = &(*last)->parent;
+            *last = table;
+        } else if (!strcmp(argv[argi], "--daemon")) {
+            daemon = true;
+        } else if (!strcmp(argv[argi], "-j") && argi + 1 < argc) {
+            numThreads = atoi(argv[++argi]);
+            if (numThreads <= 0) numThreads = DefaultThreadCount();
+        } else {
+            break;
+        }
+        argi++;
+    }
+    int status = 0;
+    PATHLIST inputs = { NULL, 0, 0 };
+    if (daemon) {
+        status = RunDaemon(&opt);
+    } else if (argi >= argc){
+        fprintf(stderr, "usage: %s [--three-pass | -j threads] [--fast-lex] [--profile[=json]] [--emit-symtab]\n"
+                        "          [--import table.stb]... <source.c | dir | @list | ->...\n"
+                        "       %s --daemon   (requests on stdin: check <path> | forget <path> | quit)\n"
+                        "       %s --diff-lexer <source.c>\n", argv[0], argv[0], argv[0]);
+        status = 1;
+    } else {
+        for (; argi < argc; argi++) {
+            CollectInputs(&inputs, argv[argi]);
+        }
+    }
+
+    if (inputs.num_item == 1) {
+        // 파일 하나면 예전처럼 바로 stdout/stderr로 출력
+        opt.numThreads = numThreads;
+        status = AnalyzeFile(inputs.item[0], &opt, stdout, stderr);
+    } else if (inputs.num_item > 1) {
+        FILETASK* tasks = (FILETASK*)calloc(inputs.num_item, sizeof(FILETASK));
+        for (int i = 0; i < inputs.num_item; i++) {
+            tasks[i].path = inputs.item[i];
+        }
+        FILEJOB job = { tasks, &opt };
+        ParallelFor(inputs.num_item, numThreads > 0 ? numThreads : 1, AnalyzeFileTask, &job);
+
+        // 끝난 순서와 상관없이 입력 순서대로 출력
+        for (int i = 0; i < inputs.num_item; i++) {
+            printf("%s==> %s <==\n", i > 0 ? "\n" : "", tasks[i].path);
+            fwrite(tasks[i].out, 1, tasks[i].outLen, stdout);
+            fflush(stdout);
+            fwrite(tasks[i].err, 1, tasks[i].errLen, stderr);
+            if (tasks[i].status != 0) status = 1;
+            free(tasks[i].out);
+            free(tasks[i].err);
+        }
+        free(tasks);
+    }
+
+    for (int i = 0; i < inputs.num_item; i++) {
+        free(inputs.item[i]);
+    }
+    free(inputs.item);
+    for (int i = 0; i < numImage; i++) {
+        UnloadSymTab(&images[i]);
+    }
+    free(images);
+    UseSymArena(&importArena);
+    FreeSymArena();
+    return status;
+}
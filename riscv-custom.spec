@@ -0,0 +1,38 @@
+# Custom RISC-V instructions (2022130828).
+#
+# riscv-gen.py turns each entry into the MATCH_/MASK_ macros and the
+# DECLARE_INSN line in riscv-opc.h, the riscv_opcodes row in riscv-opc.c,
+# the ISD node in ISDOpcodes.h, and the instruction class, definition and
+# selection pattern in RISCVInstrInfo.td.  Edit this file, then run
+#
+#     python3 riscv-gen.py
+#
+# and commit the regenerated files; "python3 riscv-gen.py --check" fails
+# if they are out of date.
+#
+# An entry starts with "insn <name>" and is followed by indented
+# "<key> <value>" lines:
+#
+#   format    r (funct7, rd/rs1/rs2) or r4 (funct2, rd/rs1/rs2/rs3)
+#   opcode    major opcode: OP, OP_32, CUSTOM_0 .. CUSTOM_3
+#   funct3    funct3 field, as 0b...
+#   funct7    funct7 field (format r)
+#   funct2    funct2 field (format r4)
+#   operands  riscv_opcodes operand string
+#   class     INSN_CLASS_* suffix
+#   isd       comment for the ISD node; the node is named like the insn
+#   td-class  name of the TableGen instruction class
+#   sched     scheduling resources: the write followed by the reads
+#   pattern   selection pattern: <dag> -> <result>
+
+insn imad
+  format    r4
+  opcode    OP
+  funct3    0b000
+  funct2    0b10
+  operands  d,s,t,r
+  class     I
+  isd       Perform a * b + c against integers
+  td-class  IMAD_rrr
+  sched     WriteIALU ReadIALU ReadIALU ReadIALU
+  pattern   (add (mul GPR:$x, GPR:$y), GPR:$z) -> (IMAD $x, $y, $z)
@@ -28,42 +28,110 @@
 #include "elf-bfd.h"
 #include "elf/riscv.h"
 #include "cpu-riscv.h"
+#include "riscv-dis.h"
 
 #include <stdint.h>
+#include <stdarg.h>
 #include <ctype.h>
-
-static enum riscv_spec_class default_priv_spec = PRIV_SPEC_CLASS_NONE;
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Per-disassemble_info state.  Everything that depends on the options or
+   on the object being disassembled lives here, so several threads can
+   disassemble different objects at the same time, each with its own
+   disassemble_info.  */
 
 struct riscv_private_data
 {
   bfd_vma gp;
   bfd_vma print_addr;
+  enum riscv_addr_base print_base;
   bfd_vma hi_addr[OP_MASK_RD + 1];
+  /* Registers whose hi_addr was read before being set, and registers
+     whose hi_addr was read or set, since these were last cleared.  Used
+     to stitch together chunks decoded in parallel.  */
+  uint32_t hi_live_in;
+  uint32_t hi_touched;
+  const char * const *gpr_names;
+  const char * const *fpr_names;
+  /* If set, disassemble as most general instruction.  */
+  int no_aliases;
+  /* Privileged spec used to name CSRs.  */
+  enum riscv_spec_class priv_spec;
+  /* Decoded-instruction cache, or NULL.  CACHE_MASK + 1 entries.  */
+  struct riscv_cache_entry *cache;
+  unsigned int cache_mask;
 };
 
-static const char * const *riscv_gpr_names;
-static const char * const *riscv_fpr_names;
+/* Decoded-instruction cache.  Repeated instruction words skip opcode
+   matching, and operand formatting too when no operand depends on the
+   pc.  It is direct-mapped on (word, xlen); the other inputs (aliases,
+   register names, privileged spec) are fixed per private data, and the
+   cache is flushed whenever options are parsed.  The lui/auipc tracking
+   is never cached: riscv_track_insn_args runs for every instruction and
+   the " # address" comment is printed from the record.  */
+
+#define RISCV_CACHE_TEXT 48
+/* Largest cache riscv_set_decode_cache makes, in entries.  */
+#define RISCV_CACHE_MAX_ENTRIES (1u << 20)
+
+enum riscv_cache_state
+{
+  RISCV_CACHE_EMPTY,
+  /* OP is known.  */
+  RISCV_CACHE_OP,
+  /* OP is known and TEXT holds the formatted operands.  */
+  RISCV_CACHE_TEXT_VALID,
+  /* OP is known; the operands must be formatted every time.  */
+  RISCV_CACHE_NO_TEXT
+};
 
-/* If set, disassemble as most general instruction.  */
-static int no_aliases;
+struct riscv_cache_entry
+{
+  insn_t word;
+  unsigned char xlen;
+  unsigned char state;
+  const struct riscv_opcode *op;
+  char text[RISCV_CACHE_TEXT];
+};
+
+static struct riscv_cache_entry *
+riscv_cache_slot (struct riscv_private_data *pd, insn_t word, unsigned xlen)
+{
+  uint64_t h = (word ^ ((uint64_t) xlen << 56)) * 0x9e3779b97f4a7c15ull;
+
+  return &pd->cache[(h >> 32) & pd->cache_mask];
+}
+
+static void
+riscv_flush_cache (struct riscv_private_data *pd)
+{
+  if (pd->cache != NULL)
+    memset (pd->cache, 0, (pd->cache_mask + 1) * sizeof (*pd->cache));
+}
 
 static void
-set_default_riscv_dis_options (void)
+set_default_riscv_dis_options (struct riscv_private_data *pd)
 {
-  riscv_gpr_names = riscv_gpr_names_abi;
-  riscv_fpr_names = riscv_fpr_names_abi;
-  no_aliases = 0;
+  pd->gpr_names = riscv_gpr_names_abi;
+  pd->fpr_names = riscv_fpr_names_abi;
+  pd->no_aliases = 0;
 }
 
 static bool
-parse_riscv_dis_option_without_args (const char *option)
+parse_riscv_dis_option_without_args (const char *option,
+				     struct riscv_private_data *pd)
 {
   if (strcmp (option, "no-aliases") == 0)
-    no_aliases = 1;
+    pd->no_aliases = 1;
   else if (strcmp (option, "numeric") == 0)
     {
-      riscv_gpr_names = riscv_gpr_names_numeric;
-      riscv_fpr_names = riscv_fpr_names_numeric;
+      pd->gpr_names = riscv_gpr_names_numeric;
+      pd->fpr_names = riscv_fpr_names_numeric;
     }
   else
     return false;
@@ -71,11 +139,11 @@ parse_riscv_dis_option_without_args (const char *option)
 }
 
 static void
-parse_riscv_dis_option (const char *option)
+parse_riscv_dis_option (const char *option, struct riscv_private_data *pd)
 {
   char *equal, *value;
 
-  if (parse_riscv_dis_option_without_args (option))
+  if (parse_riscv_dis_option_without_args (option, pd))
     return;
 
   equal = strchr (option, '=');
@@ -106,11 +174,11 @@ parse_riscv_dis_option (const char *option)
       if (priv_spec == PRIV_SPEC_CLASS_NONE)
 	opcodes_error_handler (_("unknown privileged spec set by %s=%s"),
 			       option, value);
-      else if (default_priv_spec == PRIV_SPEC_CLASS_NONE)
-	default_priv_spec = priv_spec;
-      else if (default_priv_spec != priv_spec)
+      else if (pd->priv_spec == PRIV_SPEC_CLASS_NONE)
+	pd->priv_spec = priv_spec;
+      else if (pd->priv_spec != priv_spec)
 	{
-	  RISCV_GET_PRIV_SPEC_NAME (name, default_priv_spec);
+	  RISCV_GET_PRIV_SPEC_NAME (name, pd->priv_spec);
 	  opcodes_error_handler (_("mis-matched privilege spec set by %s=%s, "
 				   "the elf privilege attribute is %s"),
 				 option, value, name);
@@ -124,17 +192,17 @@ parse_riscv_dis_option (const char *option)
 }
 
 static void
-parse_riscv_dis_options (const char *opts_in)
+parse_riscv_dis_options (const char *opts_in, struct riscv_private_data *pd)
 {
   char *opts = xstrdup (opts_in), *opt = opts, *opt_end = opts;
 
-  set_default_riscv_dis_options ();
+  set_default_riscv_dis_options (pd);
 
   for ( ; opt_end != NULL; opt = opt_end + 1)
     {
       if ((opt_end = strchr (opt, ',')) != NULL)
 	*opt_end = 0;
-      parse_riscv_dis_option (opt);
+      parse_riscv_dis_option (opt, pd);
     }
 
   free (opts);
@@ -153,32 +221,82 @@ arg_print (struct disassemble_info *info, unsigned long val,
 static void
 maybe_print_address (struct riscv_private_data *pd, int base_reg, int offset)
 {
+  pd->hi_live_in |= ~pd->hi_touched & (1u << base_reg);
+  pd->hi_touched |= 1u << base_reg;
   if (pd->hi_addr[base_reg] != (bfd_vma)-1)
     {
       pd->print_addr = (base_reg != 0 ? pd->hi_addr[base_reg] : 0) + offset;
+      pd->print_base = base_reg != 0 ? RISCV_ADDR_HI : RISCV_ADDR_ZERO;
       pd->hi_addr[base_reg] = -1;
     }
   else if (base_reg == X_GP && pd->gp != (bfd_vma)-1)
-    pd->print_addr = pd->gp + offset;
+    {
+      pd->print_addr = pd->gp + offset;
+      pd->print_base = RISCV_ADDR_GP;
+    }
   else if (base_reg == X_TP || base_reg == 0)
-    pd->print_addr = offset;
+    {
+      pd->print_addr = offset;
+      pd->print_base = base_reg != 0 ? RISCV_ADDR_TP : RISCV_ADDR_ZERO;
+    }
 }
 
-/* Print insn arguments for 32/64-bit code.  */
+/* CSR names for each privileged spec, indexed by CSR number.  */
+
+static const char *riscv_csr_hash[PRIV_SPEC_CLASS_DRAFT][4096];
 
 static void
-print_insn_args (const char *d, insn_t l, bfd_vma pc, disassemble_info *info)
+riscv_build_csr_table (enum riscv_spec_class spec, const char **csr_hash)
 {
-  struct riscv_private_data *pd = info->private_data;
-  int rs1 = (l >> OP_SH_RS1) & OP_MASK_RS1;
-  int rd = (l >> OP_SH_RD) & OP_MASK_RD;
-  fprintf_ftype print = info->fprintf_func;
+#define DECLARE_CSR(name, num, class, define_version, abort_version)	\
+  if (csr_hash[num] == NULL						\
+      && ((define_version == PRIV_SPEC_CLASS_NONE			\
+	   && abort_version == PRIV_SPEC_CLASS_NONE)			\
+	  || (spec >= define_version					\
+	      && spec < abort_version)))				\
+    csr_hash[num] = #name;
+#define DECLARE_CSR_ALIAS(name, num, class, define_version, abort_version) \
+  DECLARE_CSR (name, num, class, define_version, abort_version)
+#include "opcode/riscv-opc.h"
+#undef DECLARE_CSR
+#undef DECLARE_CSR_ALIAS
+}
 
-  if (*d != '\0')
-    print (info->stream, "\t");
+static const char *
+riscv_csr_name (enum riscv_spec_class spec, unsigned int csr)
+{
+  /* Default to the newest privileged version.  */
+  if (spec == PRIV_SPEC_CLASS_NONE)
+    spec = PRIV_SPEC_CLASS_DRAFT - 1;
+  return riscv_csr_hash[spec][csr];
+}
 
-  for (; *d != '\0'; d++)
+/* Decode the operands D of insn L at PC into OPERANDS, in the order they
+   appear in D.  Returns the number of operands.  */
+
+static unsigned int
+riscv_decode_args (const char *d, insn_t l, bfd_vma pc,
+		   struct riscv_operand *operands)
+{
+  int rs1 = (l >> OP_SH_RS1) & OP_MASK_RS1;
+  int rd = (l >> OP_SH_RD) & OP_MASK_RD;
+  const char *args = d;
+  unsigned int n = 0;
+
+#define OPERAND(KIND, VALUE)					\
+  do								\
+    {								\
+      operands[n].kind = (KIND);				\
+      operands[n].arg = arg - args;				\
+      operands[n].value = (VALUE);				\
+      n++;							\
+    }								\
+  while (0)
+
+  for (; *d != '\0' && n < RISCV_MAX_OPERANDS; d++)
     {
+      const char *arg = d;
+
       switch (*d)
 	{
 	case 'C': /* RVC */
@@ -186,77 +304,72 @@ print_insn_args (const char *d, insn_t l, bfd_vma pc, disassemble_info *info)
 	    {
 	    case 's': /* RS1 x8-x15.  */
 	    case 'w': /* RS1 x8-x15.  */
-	      print (info->stream, "%s",
-		     riscv_gpr_names[EXTRACT_OPERAND (CRS1S, l) + 8]);
+	      OPERAND (RISCV_OPERAND_GPR, EXTRACT_OPERAND (CRS1S, l) + 8);
 	      break;
 	    case 't': /* RS2 x8-x15.  */
 	    case 'x': /* RS2 x8-x15.  */
-	      print (info->stream, "%s",
-		     riscv_gpr_names[EXTRACT_OPERAND (CRS2S, l) + 8]);
+	      OPERAND (RISCV_OPERAND_GPR, EXTRACT_OPERAND (CRS2S, l) + 8);
 	      break;
 	    case 'U': /* RS1, constrained to equal RD.  */
-	      print (info->stream, "%s", riscv_gpr_names[rd]);
+	      OPERAND (RISCV_OPERAND_GPR, rd);
 	      break;
 	    case 'c': /* RS1, constrained to equal sp.  */
-	      print (info->stream, "%s", riscv_gpr_names[X_SP]);
+	      OPERAND (RISCV_OPERAND_GPR, X_SP);
 	      break;
 	    case 'V': /* RS2 */
-	      print (info->stream, "%s",
-		     riscv_gpr_names[EXTRACT_OPERAND (CRS2, l)]);
+	      OPERAND (RISCV_OPERAND_GPR, EXTRACT_OPERAND (CRS2, l));
 	      break;
 	    case 'o':
 	    case 'j':
-	      print (info->stream, "%d", (int)EXTRACT_CITYPE_IMM (l));
+	      OPERAND (RISCV_OPERAND_IMM, (int)EXTRACT_CITYPE_IMM (l));
 	      break;
 	    case 'k':
-	      print (info->stream, "%d", (int)EXTRACT_CLTYPE_LW_IMM (l));
+	      OPERAND (RISCV_OPERAND_IMM, (int)EXTRACT_CLTYPE_LW_IMM (l));
 	      break;
 	    case 'l':
-	      print (info->stream, "%d", (int)EXTRACT_CLTYPE_LD_IMM (l));
+	      OPERAND (RISCV_OPERAND_IMM, (int)EXTRACT_CLTYPE_LD_IMM (l));
 	      break;
 	    case 'm':
-	      print (info->stream, "%d", (int)EXTRACT_CITYPE_LWSP_IMM (l));
+	      OPERAND (RISCV_OPERAND_IMM, (int)EXTRACT_CITYPE_LWSP_IMM (l));
 	      break;
 	    case 'n':
-	      print (info->stream, "%d", (int)EXTRACT_CITYPE_LDSP_IMM (l));
+	      OPERAND (RISCV_OPERAND_IMM, (int)EXTRACT_CITYPE_LDSP_IMM (l));
 	      break;
 	    case 'K':
-	      print (info->stream, "%d", (int)EXTRACT_CIWTYPE_ADDI4SPN_IMM (l));
+	      OPERAND (RISCV_OPERAND_IMM,
+		       (int)EXTRACT_CIWTYPE_ADDI4SPN_IMM (l));
 	      break;
 	    case 'L':
-	      print (info->stream, "%d", (int)EXTRACT_CITYPE_ADDI16SP_IMM (l));
+	      OPERAND (RISCV_OPERAND_IMM,
+		       (int)EXTRACT_CITYPE_ADDI16SP_IMM (l));
 	      break;
 	    case 'M':
-	      print (info->stream, "%d", (int)EXTRACT_CSSTYPE_SWSP_IMM (l));
+	      OPERAND (RISCV_OPERAND_IMM, (int)EXTRACT_CSSTYPE_SWSP_IMM (l));
 	      break;
 	    case 'N':
-	      print (info->stream, "%d", (int)EXTRACT_CSSTYPE_SDSP_IMM (l));
+	      OPERAND (RISCV_OPERAND_IMM, (int)EXTRACT_CSSTYPE_SDSP_IMM (l));
 	      break;
 	    case 'p':
-	      info->target = EXTRACT_CBTYPE_IMM (l) + pc;
-	      (*info->print_address_func) (info->target, info);
+	      OPERAND (RISCV_OPERAND_ADDRESS, EXTRACT_CBTYPE_IMM (l) + pc);
 	      break;
 	    case 'a':
-	      info->target = EXTRACT_CJTYPE_IMM (l) + pc;
-	      (*info->print_address_func) (info->target, info);
+	      OPERAND (RISCV_OPERAND_ADDRESS, EXTRACT_CJTYPE_IMM (l) + pc);
 	      break;
 	    case 'u':
-	      print (info->stream, "0x%x",
-		     (int)(EXTRACT_CITYPE_IMM (l) & (RISCV_BIGIMM_REACH-1)));
+	      OPERAND (RISCV_OPERAND_UIMM,
+		       (int)(EXTRACT_CITYPE_IMM (l) & (RISCV_BIGIMM_REACH-1)));
 	      break;
 	    case '>':
-	      print (info->stream, "0x%x", (int)EXTRACT_CITYPE_IMM (l) & 0x3f);
+	      OPERAND (RISCV_OPERAND_UIMM, (int)EXTRACT_CITYPE_IMM (l) & 0x3f);
 	      break;
 	    case '<':
-	      print (info->stream, "0x%x", (int)EXTRACT_CITYPE_IMM (l) & 0x1f);
+	      OPERAND (RISCV_OPERAND_UIMM, (int)EXTRACT_CITYPE_IMM (l) & 0x1f);
 	      break;
 	    case 'T': /* Floating-point RS2.  */
-	      print (info->stream, "%s",
-		     riscv_fpr_names[EXTRACT_OPERAND (CRS2, l)]);
+	      OPERAND (RISCV_OPERAND_FPR, EXTRACT_OPERAND (CRS2, l));
 	      break;
 	    case 'D': /* Floating-point RS2 x8-x15.  */
-	      print (info->stream, "%s",
-		     riscv_fpr_names[EXTRACT_OPERAND (CRS2S, l) + 8]);
+	      OPERAND (RISCV_OPERAND_FPR, EXTRACT_OPERAND (CRS2S, l) + 8);
 	      break;
 	    }
 	  break;
@@ -266,299 +379,872 @@ print_insn_args (const char *d, insn_t l, bfd_vma pc, disassemble_info *info)
 	case ')':
 	case '[':
 	case ']':
-	  print (info->stream, "%c", *d);
 	  break;
 
 	case '0':
 	  /* Only print constant 0 if it is the last argument.  */
 	  if (!d[1])
-	    print (info->stream, "0");
+	    OPERAND (RISCV_OPERAND_IMM, 0);
 	  break;
 
 	case 'b':
 	case 's':
-	  if ((l & MASK_JALR) == MATCH_JALR)
-	    maybe_print_address (pd, rs1, 0);
-	  print (info->stream, "%s", riscv_gpr_names[rs1]);
+	  OPERAND (RISCV_OPERAND_GPR, rs1);
 	  break;
 
 	case 't':
-	  print (info->stream, "%s",
-		 riscv_gpr_names[EXTRACT_OPERAND (RS2, l)]);
+	  OPERAND (RISCV_OPERAND_GPR, EXTRACT_OPERAND (RS2, l));
 	  break;
 
 	// 2022130828
 	case 'r':
-		print (info->stream, "%s", riscv_gpr_names[EXTRACT_OPERAND (RS3, l)]);
+		OPERAND (RISCV_OPERAND_GPR, EXTRACT_OPERAND (RS3, l));
 		break;
 
 	case 'u':
-	  print (info->stream, "0x%x",
-		 (unsigned)EXTRACT_UTYPE_IMM (l) >> RISCV_IMM_BITS);
+	  OPERAND (RISCV_OPERAND_UIMM,
+		   (unsigned)EXTRACT_UTYPE_IMM (l) >> RISCV_IMM_BITS);
 	  break;
 
 	case 'm':
-	  arg_print (info, EXTRACT_OPERAND (RM, l),
-		     riscv_rm, ARRAY_SIZE (riscv_rm));
+	  OPERAND (RISCV_OPERAND_ROUNDING, EXTRACT_OPERAND (RM, l));
 	  break;
 
 	case 'P':
-	  arg_print (info, EXTRACT_OPERAND (PRED, l),
-		     riscv_pred_succ, ARRAY_SIZE (riscv_pred_succ));
+	  OPERAND (RISCV_OPERAND_FENCE, EXTRACT_OPERAND (PRED, l));
 	  break;
 
 	case 'Q':
-	  arg_print (info, EXTRACT_OPERAND (SUCC, l),
-		     riscv_pred_succ, ARRAY_SIZE (riscv_pred_succ));
+	  OPERAND (RISCV_OPERAND_FENCE, EXTRACT_OPERAND (SUCC, l));
 	  break;
 
 	case 'o':
-	  maybe_print_address (pd, rs1, EXTRACT_ITYPE_IMM (l));
-	  /* Fall through.  */
 	case 'j':
-	  if (((l & MASK_ADDI) == MATCH_ADDI && rs1 != 0)
-	      || (l & MASK_JALR) == MATCH_JALR)
-	    maybe_print_address (pd, rs1, EXTRACT_ITYPE_IMM (l));
-	  print (info->stream, "%d", (int)EXTRACT_ITYPE_IMM (l));
+	  OPERAND (RISCV_OPERAND_IMM, (int)EXTRACT_ITYPE_IMM (l));
 	  break;
 
 	case 'q':
-	  maybe_print_address (pd, rs1, EXTRACT_STYPE_IMM (l));
-	  print (info->stream, "%d", (int)EXTRACT_STYPE_IMM (l));
+	  OPERAND (RISCV_OPERAND_IMM, (int)EXTRACT_STYPE_IMM (l));
 	  break;
 
 	case 'a':
-	  info->target = EXTRACT_JTYPE_IMM (l) + pc;
-	  (*info->print_address_func) (info->target, info);
+	  OPERAND (RISCV_OPERAND_ADDRESS, EXTRACT_JTYPE_IMM (l) + pc);
 	  break;
 
 	case 'p':
-	  info->target = EXTRACT_BTYPE_IMM (l) + pc;
-	  (*info->print_address_func) (info->target, info);
+	  OPERAND (RISCV_OPERAND_ADDRESS, EXTRACT_BTYPE_IMM (l) + pc);
 	  break;
 
 	case 'd':
-	  if ((l & MASK_AUIPC) == MATCH_AUIPC)
-	    pd->hi_addr[rd] = pc + EXTRACT_UTYPE_IMM (l);
-	  else if ((l & MASK_LUI) == MATCH_LUI)
-	    pd->hi_addr[rd] = EXTRACT_UTYPE_IMM (l);
-	  else if ((l & MASK_C_LUI) == MATCH_C_LUI)
-	    pd->hi_addr[rd] = EXTRACT_CITYPE_LUI_IMM (l);
-	  print (info->stream, "%s", riscv_gpr_names[rd]);
+	  OPERAND (RISCV_OPERAND_GPR, rd);
 	  break;
 
 	case 'z':
-	  print (info->stream, "%s", riscv_gpr_names[0]);
+	  OPERAND (RISCV_OPERAND_GPR, 0);
 	  break;
 
 	case '>':
-	  print (info->stream, "0x%x", (int)EXTRACT_OPERAND (SHAMT, l));
+	  OPERAND (RISCV_OPERAND_UIMM, (int)EXTRACT_OPERAND (SHAMT, l));
 	  break;
 
 	case '<':
-	  print (info->stream, "0x%x", (int)EXTRACT_OPERAND (SHAMTW, l));
+	  OPERAND (RISCV_OPERAND_UIMM, (int)EXTRACT_OPERAND (SHAMTW, l));
 	  break;
 
 	case 'S':
 	case 'U':
-	  print (info->stream, "%s", riscv_fpr_names[rs1]);
+	  OPERAND (RISCV_OPERAND_FPR, rs1);
 	  break;
 
 	case 'T':
-	  print (info->stream, "%s", riscv_fpr_names[EXTRACT_OPERAND (RS2, l)]);
+	  OPERAND (RISCV_OPERAND_FPR, EXTRACT_OPERAND (RS2, l));
 	  break;
 
 	case 'D':
-	  print (info->stream, "%s", riscv_fpr_names[rd]);
+	  OPERAND (RISCV_OPERAND_FPR, rd);
 	  break;
 
 	case 'R':
-	  print (info->stream, "%s", riscv_fpr_names[EXTRACT_OPERAND (RS3, l)]);
+	  OPERAND (RISCV_OPERAND_FPR, EXTRACT_OPERAND (RS3, l));
 	  break;
 
 	case 'E':
-	  {
-	    static const char *riscv_csr_hash[4096]; /* Total 2^12 CSRs.  */
-	    static bool init_csr = false;
-	    unsigned int csr = EXTRACT_OPERAND (CSR, l);
+	  OPERAND (RISCV_OPERAND_CSR, EXTRACT_OPERAND (CSR, l));
+	  break;
 
-	    if (!init_csr)
-	      {
-		unsigned int i;
-		for (i = 0; i < 4096; i++)
-		  riscv_csr_hash[i] = NULL;
+	case 'Z':
+	  OPERAND (RISCV_OPERAND_IMM, rs1);
+	  break;
 
-		/* Set to the newest privileged version.  */
-		if (default_priv_spec == PRIV_SPEC_CLASS_NONE)
-		  default_priv_spec = PRIV_SPEC_CLASS_DRAFT - 1;
+	default:
+	  OPERAND (RISCV_OPERAND_INVALID, *d);
+	  return n;
+	}
+    }
+#undef OPERAND
+  return n;
+}
 
-#define DECLARE_CSR(name, num, class, define_version, abort_version)	\
-		if (riscv_csr_hash[num] == NULL 			\
-		    && ((define_version == PRIV_SPEC_CLASS_NONE 	\
-			 && abort_version == PRIV_SPEC_CLASS_NONE)	\
-			|| (default_priv_spec >= define_version 	\
-			    && default_priv_spec < abort_version)))	\
-		  riscv_csr_hash[num] = #name;
-#define DECLARE_CSR_ALIAS(name, num, class, define_version, abort_version) \
-		DECLARE_CSR (name, num, class, define_version, abort_version)
-#include "opcode/riscv-opc.h"
-#undef DECLARE_CSR
-	      }
+unsigned int
+riscv_decode_operands (const struct riscv_insn_record *rec,
+		       struct riscv_operand *operands)
+{
+  if (rec->op == NULL)
+    return 0;
+  return riscv_decode_args (rec->op->args, rec->word, rec->address, operands);
+}
 
-	    if (riscv_csr_hash[csr] != NULL)
-	      print (info->stream, "%s", riscv_csr_hash[csr]);
-	    else
-	      print (info->stream, "0x%x", csr);
-	    break;
-	  }
+/* Print insn arguments for 32/64-bit code.  The operands come from
+   riscv_decode_args; the punctuation between them from D.  Printing has
+   no side effects on the private data; the lui/auipc tracking is done by
+   riscv_track_insn_args.  */
 
-	case 'Z':
-	  print (info->stream, "%d", rs1);
+static void
+print_insn_args (const char *d, insn_t l, bfd_vma pc, disassemble_info *info)
+{
+  struct riscv_private_data *pd = info->private_data;
+  struct riscv_operand operands[RISCV_MAX_OPERANDS];
+  unsigned int n = riscv_decode_args (d, l, pc, operands), i;
+  fprintf_ftype print = info->fprintf_func;
+  const char *p = d, *stop;
+
+  if (*d != '\0')
+    print (info->stream, "\t");
+
+  for (i = 0; ; i++)
+    {
+      const struct riscv_operand *operand = &operands[i];
+      const char *name;
+
+      /* Print the punctuation before the next operand, skipping letters
+	 that did not produce one.  */
+      stop = i < n ? d + operand->arg : d + strlen (d);
+      for (; p < stop; p++)
+	if (*p == 'C')
+	  p++;
+	else if (strchr (",()[]", *p) != NULL)
+	  print (info->stream, "%c", *p);
+      if (i == n)
+	break;
+      p += *p == 'C' ? 2 : 1;
+
+      switch (operand->kind)
+	{
+	case RISCV_OPERAND_GPR:
+	  print (info->stream, "%s", pd->gpr_names[operand->value]);
 	  break;
 
-	default:
+	case RISCV_OPERAND_FPR:
+	  print (info->stream, "%s", pd->fpr_names[operand->value]);
+	  break;
+
+	case RISCV_OPERAND_IMM:
+	  print (info->stream, "%d", (int)operand->value);
+	  break;
+
+	case RISCV_OPERAND_UIMM:
+	  print (info->stream, "0x%x", (int)operand->value);
+	  break;
+
+	case RISCV_OPERAND_ADDRESS:
+	  info->target = operand->value;
+	  (*info->print_address_func) (info->target, info);
+	  break;
+
+	case RISCV_OPERAND_CSR:
+	  name = riscv_csr_name (pd->priv_spec, operand->value);
+	  if (name != NULL)
+	    print (info->stream, "%s", name);
+	  else
+	    print (info->stream, "0x%x", (int)operand->value);
+	  break;
+
+	case RISCV_OPERAND_ROUNDING:
+	  arg_print (info, operand->value, riscv_rm, ARRAY_SIZE (riscv_rm));
+	  break;
+
+	case RISCV_OPERAND_FENCE:
+	  arg_print (info, operand->value,
+		     riscv_pred_succ, ARRAY_SIZE (riscv_pred_succ));
+	  break;
+
+	case RISCV_OPERAND_INVALID:
 	  /* xgettext:c-format */
 	  print (info->stream, _("# internal error, undefined modifier (%c)"),
-		 *d);
+		 (int)operand->value);
 	  return;
 	}
     }
 }
 
-/* Print the RISC-V instruction at address MEMADDR in debugged memory,
-   on using INFO.  Returns length of the instruction, in bytes.
-   BIGENDIAN must be 1 if this is big-endian code, 0 if
-   this is little-endian code.  */
+/* Follow the operands D of insn L at PC the way print_insn_args walks
+   them, and update the lui/auipc tracking in PD.  Store the branch or
+   jump target, if any, in *TARGET.  */
 
-static int
-riscv_disassemble_insn (bfd_vma memaddr, insn_t word, disassemble_info *info)
+static void
+riscv_track_insn_args (const char *d, insn_t l, bfd_vma pc,
+		       struct riscv_private_data *pd, bfd_vma *target)
+{
+  int rs1 = (l >> OP_SH_RS1) & OP_MASK_RS1;
+  int rd = (l >> OP_SH_RD) & OP_MASK_RD;
+
+  for (; *d != '\0'; d++)
+    {
+      switch (*d)
+	{
+	case 'C': /* RVC */
+	  switch (*++d)
+	    {
+	    case 'p':
+	      *target = EXTRACT_CBTYPE_IMM (l) + pc;
+	      break;
+	    case 'a':
+	      *target = EXTRACT_CJTYPE_IMM (l) + pc;
+	      break;
+	    }
+	  break;
+
+	case 'b':
+	case 's':
+	  if ((l & MASK_JALR) == MATCH_JALR)
+	    maybe_print_address (pd, rs1, 0);
+	  break;
+
+	case 'o':
+	  maybe_print_address (pd, rs1, EXTRACT_ITYPE_IMM (l));
+	  /* Fall through.  */
+	case 'j':
+	  if (((l & MASK_ADDI) == MATCH_ADDI && rs1 != 0)
+	      || (l & MASK_JALR) == MATCH_JALR)
+	    maybe_print_address (pd, rs1, EXTRACT_ITYPE_IMM (l));
+	  break;
+
+	case 'q':
+	  maybe_print_address (pd, rs1, EXTRACT_STYPE_IMM (l));
+	  break;
+
+	case 'a':
+	  *target = EXTRACT_JTYPE_IMM (l) + pc;
+	  break;
+
+	case 'p':
+	  *target = EXTRACT_BTYPE_IMM (l) + pc;
+	  break;
+
+	case 'd':
+	  if ((l & MASK_AUIPC) == MATCH_AUIPC)
+	    pd->hi_addr[rd] = pc + EXTRACT_UTYPE_IMM (l);
+	  else if ((l & MASK_LUI) == MATCH_LUI)
+	    pd->hi_addr[rd] = EXTRACT_UTYPE_IMM (l);
+	  else if ((l & MASK_C_LUI) == MATCH_C_LUI)
+	    pd->hi_addr[rd] = EXTRACT_CITYPE_LUI_IMM (l);
+	  else
+	    break;
+	  pd->hi_touched |= 1u << rd;
+	  break;
+
+	case ',': case '(': case ')': case '[': case ']': case '0':
+	case 't': case 'r': case 'u': case 'm': case 'P': case 'Q':
+	case 'z': case '>': case '<': case 'S': case 'U': case 'T':
+	case 'D': case 'R': case 'E': case 'Z':
+	  break;
+
+	default:
+	  /* print_insn_args stops at an undefined modifier.  */
+	  return;
+	}
+    }
+}
+
+/* Decode table for riscv_disassemble_insn.  The first level is indexed
+   by the major opcode and funct3 (the quadrant and funct3 for compressed
+   instructions).  Slots with more than DECODE_SPLIT candidates get a
+   second level, indexed by funct7 (bits 12:10 and 6:5 for compressed
+   instructions).  Each slot lists, in table order, every entry of
+   riscv_opcodes whose fixed bits agree with the bits the slot is keyed
+   on, so the first entry that accepts a word is the one a linear scan
+   of the table would have found, and alias priority is unchanged.
+   Macros never match and are left out.
+
+   The entries carry their match function as RISCV_MATCH_* constraints,
+   plus whether they are aliases or need a certain XLEN, so matching a
+   word is one mask test and one constraint test per candidate with no
+   indirect calls.  */
+
+#define DECODE_SPLIT 6
+
+#define DECODE_IDX(i) \
+  (((i) & OP_MASK_OP) | (((i) >> OP_SH_FUNCT3) & OP_MASK_FUNCT3) << 7)
+#define DECODE_MASK \
+  ((OP_MASK_OP << OP_SH_OP) | (OP_MASK_FUNCT3 << OP_SH_FUNCT3))
+#define DECODE_SUB_IDX(i) (((i) >> OP_SH_FUNCT7) & OP_MASK_FUNCT7)
+#define DECODE_SUB_MASK ((insn_t) OP_MASK_FUNCT7 << OP_SH_FUNCT7)
+
+#define DECODE_RVC_IDX(i) \
+  (((i) & OP_MASK_OP2) | (((i) >> OP_SH_CFUNCT3) & OP_MASK_CFUNCT3) << 2)
+#define DECODE_RVC_MASK \
+  ((OP_MASK_OP2 << OP_SH_OP2) | (OP_MASK_CFUNCT3 << OP_SH_CFUNCT3))
+#define DECODE_RVC_SUB_IDX(i) ((((i) >> 10) & 0x7) | (((i) >> 5) & 0x3) << 3)
+#define DECODE_RVC_SUB_MASK ((0x7 << 10) | (0x3 << 5))
+
+/* Constraints added to the RISCV_MATCH_* ones of an entry: it is an
+   alias, or it needs XLEN to be 32 or 64 (both if it needs some other
+   XLEN).  */
+#define DECODE_ALIAS (1u << 16)
+#define DECODE_RV32 (1u << 17)
+#define DECODE_RV64 (1u << 18)
+
+struct riscv_decode_entry
 {
+  insn_t match;
+  insn_t mask;
+  unsigned int constraints;
+  /* The riscv_opcodes entry, or NULL at the end of a slot.  */
   const struct riscv_opcode *op;
-  static bool init = 0;
-  static const struct riscv_opcode *riscv_hash[OP_MASK_OP + 1];
-  struct riscv_private_data *pd;
-  int insnlen;
+};
+
+struct riscv_decode_slot
+{
+  /* Candidates in table order.  */
+  const struct riscv_decode_entry *ops;
+  /* Second level, or NULL.  */
+  struct riscv_decode_slot *sub;
+};
+
+static struct riscv_decode_slot riscv_decode[(OP_MASK_OP + 1) << 3];
+static struct riscv_decode_slot riscv_decode_rvc[4 << 3];
+static const struct riscv_decode_entry riscv_decode_none[1];
+
+/* Return the entries of SRC that can match a word whose bits under
+   KEYMASK equal KEY, and store their number in COUNT.  */
+
+static const struct riscv_decode_entry *
+riscv_decode_filter (const struct riscv_decode_entry *src, insn_t key,
+		     insn_t keymask, unsigned *count)
+{
+  const struct riscv_decode_entry *e;
+  struct riscv_decode_entry *ops;
+  unsigned n = 0;
+
+  for (e = src; e->op != NULL; e++)
+    if (((key ^ e->match) & e->mask & keymask) == 0)
+      n++;
+  *count = n;
+  if (n == 0)
+    return riscv_decode_none;
+
+  ops = xmalloc ((n + 1) * sizeof (*ops));
+  n = 0;
+  for (e = src; e->op != NULL; e++)
+    if (((key ^ e->match) & e->mask & keymask) == 0)
+      ops[n++] = *e;
+  memset (&ops[n], 0, sizeof (ops[n]));
+  return ops;
+}
+
+/* Fill the first-level slot for KEY and split it if it is crowded.  */
+
+static void
+riscv_decode_fill (struct riscv_decode_slot *slot,
+		   const struct riscv_decode_entry *src, insn_t key, bool rvc)
+{
+  insn_t keymask = rvc ? DECODE_RVC_MASK : DECODE_MASK;
+  unsigned count, i;
+
+  slot->ops = riscv_decode_filter (src, key, keymask, &count);
+  if (count <= DECODE_SPLIT)
+    return;
+
+  if (rvc)
+    {
+      slot->sub = xcalloc (4 << 3, sizeof (*slot->sub));
+      for (i = 0; i < 4 << 3; i++)
+	slot->sub[i].ops
+	  = riscv_decode_filter (slot->ops,
+				 key | (i & 0x7) << 10 | (i >> 3) << 5,
+				 keymask | DECODE_RVC_SUB_MASK, &count);
+    }
+  else
+    {
+      slot->sub = xcalloc (OP_MASK_FUNCT7 + 1, sizeof (*slot->sub));
+      for (i = 0; i <= OP_MASK_FUNCT7; i++)
+	slot->sub[i].ops
+	  = riscv_decode_filter (slot->ops, key | (insn_t) i << OP_SH_FUNCT7,
+				 keymask | DECODE_SUB_MASK, &count);
+    }
+}
+
+/* Return the decode table entry for OP.  */
+
+static struct riscv_decode_entry
+riscv_decode_entry (const struct riscv_opcode *op)
+{
+  struct riscv_decode_entry e;
+
+  e.match = op->match;
+  e.mask = op->mask;
+  e.constraints = riscv_match_constraints (op);
+  if (op->pinfo & INSN_ALIAS)
+    e.constraints |= DECODE_ALIAS;
+  if (op->xlen_requirement != 0 && op->xlen_requirement != 64)
+    e.constraints |= DECODE_RV32;
+  if (op->xlen_requirement != 0 && op->xlen_requirement != 32)
+    e.constraints |= DECODE_RV64;
+  e.op = op;
+  return e;
+}
+
+static void
+riscv_build_decode_table (void)
+{
+  const struct riscv_opcode *op;
+  struct riscv_decode_entry *wide, *rvc;
+  unsigned nwide = 0, nrvc = 0, i;
+
+  for (op = riscv_opcodes; op->name; op++)
+    if (op->pinfo != INSN_MACRO)
+      {
+	if (riscv_insn_length (op->match) == 2)
+	  nrvc++;
+	else
+	  nwide++;
+      }
+  wide = xmalloc ((nwide + 1) * sizeof (*wide));
+  rvc = xmalloc ((nrvc + 1) * sizeof (*rvc));
+  nwide = nrvc = 0;
+  for (op = riscv_opcodes; op->name; op++)
+    if (op->pinfo != INSN_MACRO)
+      {
+	if (riscv_insn_length (op->match) == 2)
+	  rvc[nrvc++] = riscv_decode_entry (op);
+	else
+	  wide[nwide++] = riscv_decode_entry (op);
+      }
+  memset (&wide[nwide], 0, sizeof (wide[nwide]));
+  memset (&rvc[nrvc], 0, sizeof (rvc[nrvc]));
+
+  for (i = 0; i < ARRAY_SIZE (riscv_decode); i++)
+    riscv_decode_fill (&riscv_decode[i], wide,
+		       (i & OP_MASK_OP) | (insn_t) (i >> 7) << OP_SH_FUNCT3,
+		       false);
+  for (i = 0; i < ARRAY_SIZE (riscv_decode_rvc); i++)
+    riscv_decode_fill (&riscv_decode_rvc[i], rvc,
+		       (i & 0x3) | (insn_t) (i >> 2) << OP_SH_CFUNCT3, true);
+
+  free (wide);
+  free (rvc);
+}
+
+/* Return the candidate list for WORD.  */
+
+static const struct riscv_decode_entry *
+riscv_decode_lookup (insn_t word)
+{
+  const struct riscv_decode_slot *slot;
+
+  if (riscv_insn_length (word) == 2)
+    {
+      slot = &riscv_decode_rvc[DECODE_RVC_IDX (word)];
+      if (slot->sub != NULL)
+	slot = &slot->sub[DECODE_RVC_SUB_IDX (word)];
+    }
+  else
+    {
+      slot = &riscv_decode[DECODE_IDX (word)];
+      if (slot->sub != NULL)
+	slot = &slot->sub[DECODE_SUB_IDX (word)];
+    }
+  return slot->ops;
+}
+
+/* Build the tables shared by every disassemble_info.  They only depend on
+   riscv_opcodes and riscv-opc.h, so they are built once per process.  */
+
+static void
+riscv_init_tables (void)
+{
+  int spec;
+
+  riscv_build_decode_table ();
+  for (spec = PRIV_SPEC_CLASS_NONE + 1; spec < PRIV_SPEC_CLASS_DRAFT; spec++)
+    riscv_build_csr_table (spec, riscv_csr_hash[spec]);
+}
+
+#ifdef HAVE_PTHREAD_H
+static pthread_once_t riscv_tables_once = PTHREAD_ONCE_INIT;
+#else
+/* 0: not built, 1: being built, 2: built.  */
+static int riscv_tables_state;
+#endif
+
+static void
+riscv_ensure_tables (void)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_once (&riscv_tables_once, riscv_init_tables);
+#else
+  int state = 0;
+
+  if (__atomic_load_n (&riscv_tables_state, __ATOMIC_ACQUIRE) == 2)
+    return;
+  /* The first caller builds the tables; the others wait for it.  */
+  if (__atomic_compare_exchange_n (&riscv_tables_state, &state, 1, false,
+				   __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+    {
+      riscv_init_tables ();
+      __atomic_store_n (&riscv_tables_state, 2, __ATOMIC_RELEASE);
+    }
+  else
+    while (__atomic_load_n (&riscv_tables_state, __ATOMIC_ACQUIRE) != 2)
+      ;
+#endif
+}
+
+/* Privileged spec of the last object passed to riscv_get_disassembler.
+   Used when the object that owns INFO->section has none, or there is no
+   section, as in gdb.  */
+static enum riscv_spec_class riscv_default_priv_spec = PRIV_SPEC_CLASS_NONE;
+
+/* Return the privileged spec recorded in the ELF attributes of ABFD, or
+   PRIV_SPEC_CLASS_NONE.  */
+
+static enum riscv_spec_class
+riscv_elf_priv_spec (bfd *abfd)
+{
+  enum riscv_spec_class priv_spec = PRIV_SPEC_CLASS_NONE;
+
+  if (abfd)
+    {
+      const struct elf_backend_data *ebd = get_elf_backend_data (abfd);
+      if (ebd)
+        {
+	  const char *sec_name = ebd->obj_attrs_section;
+	  if (bfd_get_section_by_name (abfd, sec_name) != NULL)
+	    {
+	      obj_attribute *attr = elf_known_obj_attributes_proc (abfd);
+	      unsigned int Tag_a = Tag_RISCV_priv_spec;
+	      unsigned int Tag_b = Tag_RISCV_priv_spec_minor;
+	      unsigned int Tag_c = Tag_RISCV_priv_spec_revision;
+	      riscv_get_priv_spec_class_from_numbers (attr[Tag_a].i,
+						      attr[Tag_b].i,
+						      attr[Tag_c].i,
+						      &priv_spec);
+	    }
+        }
+    }
+  return priv_spec;
+}
+
+/* Return the private data of INFO, creating it on first use.  The
+   privileged spec comes from the object that owns INFO->section, or else
+   from riscv_get_disassembler, and the disassembler options are applied
+   on top.  */
 
-#define OP_HASH_IDX(i) ((i) & (riscv_insn_length (i) == 2 ? 0x3 : OP_MASK_OP))
+static struct riscv_private_data *
+riscv_get_private_data (disassemble_info *info)
+{
+  struct riscv_private_data *pd = info->private_data;
+  int i;
+
+  if (pd != NULL)
+    return pd;
+
+  riscv_ensure_tables ();
+
+  pd = info->private_data = xcalloc (1, sizeof (struct riscv_private_data));
+  pd->gp = -1;
+  pd->print_addr = -1;
+  for (i = 0; i < (int)ARRAY_SIZE (pd->hi_addr); i++)
+    pd->hi_addr[i] = -1;
+
+  for (i = 0; i < info->symtab_size; i++)
+    if (strcmp (bfd_asymbol_name (info->symtab[i]), RISCV_GP_SYMBOL) == 0)
+      pd->gp = bfd_asymbol_value (info->symtab[i]);
+
+  set_default_riscv_dis_options (pd);
+  if (info->section != NULL)
+    pd->priv_spec = riscv_elf_priv_spec (info->section->owner);
+  if (pd->priv_spec == PRIV_SPEC_CLASS_NONE)
+    pd->priv_spec = __atomic_load_n (&riscv_default_priv_spec,
+				     __ATOMIC_RELAXED);
+  return pd;
+}
+
+/* Return the private data of INFO, applying any pending disassembler
+   options.  */
 
-  /* Build a hash table to shorten the search time.  */
-  if (! init)
+static struct riscv_private_data *
+riscv_setup_info (disassemble_info *info)
+{
+  struct riscv_private_data *pd = riscv_get_private_data (info);
+
+  if (info->disassembler_options != NULL)
     {
-      for (op = riscv_opcodes; op->name; op++)
-	if (!riscv_hash[OP_HASH_IDX (op->match)])
-	  riscv_hash[OP_HASH_IDX (op->match)] = op;
+      parse_riscv_dis_options (info->disassembler_options, pd);
+      /* Avoid repeatedly parsing the options.  */
+      info->disassembler_options = NULL;
+      riscv_flush_cache (pd);
+    }
+  return pd;
+}
+
+/* Return the XLEN to decode for.  If it is not known, get its value from
+   the ELF class.  */
 
-      init = 1;
+static unsigned
+riscv_xlen (disassemble_info *info)
+{
+  if (info->mach == bfd_mach_riscv64)
+    return 64;
+  else if (info->mach == bfd_mach_riscv32)
+    return 32;
+  else if (info->section != NULL)
+    {
+      Elf_Internal_Ehdr *ehdr = elf_elfheader (info->section->owner);
+      return ehdr->e_ident[EI_CLASS] == ELFCLASS64 ? 64 : 32;
     }
+  return 0;
+}
 
-  if (info->private_data == NULL)
+/* Return the riscv_opcodes entry WORD decodes to, or NULL.  */
+
+static const struct riscv_opcode *
+riscv_match_opcode (struct riscv_private_data *pd, unsigned xlen,
+		    insn_t word)
+{
+  const struct riscv_decode_entry *e;
+  unsigned int fails = riscv_match_failures (word);
+
+  /* Is this a pseudo-instruction and may we print it as such?  */
+  if (pd->no_aliases)
+    fails |= DECODE_ALIAS;
+  /* Is this instruction restricted to a certain value of XLEN?  */
+  if (xlen != 32)
+    fails |= DECODE_RV32;
+  if (xlen != 64)
+    fails |= DECODE_RV64;
+
+  for (e = riscv_decode_lookup (word); e->op != NULL; e++)
+    if (((word ^ e->match) & e->mask) == 0
+	&& (e->constraints & fails) == 0
+	&& ((e->constraints & RISCV_MATCH_FUNC) == 0
+	    || (e->op->match_func) (e->op, word)))
+      return e->op;
+  return NULL;
+}
+
+/* Decode WORD at MEMADDR into REC and update the lui/auipc tracking in
+   PD.  */
+
+static void
+riscv_decode_insn (struct riscv_private_data *pd, unsigned xlen,
+		   bfd_vma memaddr, insn_t word, struct riscv_insn_record *rec)
+{
+  const struct riscv_opcode *op;
+
+  rec->address = memaddr;
+  rec->word = word;
+  rec->length = riscv_insn_length (word);
+  rec->op = NULL;
+  rec->rd = EXTRACT_OPERAND (RD, word);
+  rec->rs1 = EXTRACT_OPERAND (RS1, word);
+  rec->rs2 = EXTRACT_OPERAND (RS2, word);
+  rec->rs3 = EXTRACT_OPERAND (RS3, word);
+  rec->insn_type = dis_noninsn;
+  rec->data_size = 0;
+  rec->target = 0;
+  rec->addr_comment = false;
+  rec->addr_base = RISCV_ADDR_HI;
+
+  if (pd->cache != NULL)
     {
-      int i;
+      struct riscv_cache_entry *entry = riscv_cache_slot (pd, word, xlen);
+
+      if (entry->state != RISCV_CACHE_EMPTY
+	  && entry->word == word && entry->xlen == xlen)
+	op = entry->op;
+      else
+	{
+	  op = riscv_match_opcode (pd, xlen, word);
+	  entry->word = word;
+	  entry->xlen = xlen;
+	  entry->state = RISCV_CACHE_OP;
+	  entry->op = op;
+	}
+    }
+  else
+    op = riscv_match_opcode (pd, xlen, word);
+  if (op == NULL)
+    return;
 
-      pd = info->private_data = xcalloc (1, sizeof (struct riscv_private_data));
-      pd->gp = -1;
+  rec->op = op;
+  riscv_track_insn_args (op->args, word, memaddr, pd, &rec->target);
+
+  /* Try to disassemble multi-instruction addressing sequences.  */
+  if (pd->print_addr != (bfd_vma)-1)
+    {
+      rec->target = pd->print_addr;
+      rec->addr_comment = true;
+      rec->addr_base = pd->print_base;
       pd->print_addr = -1;
-      for (i = 0; i < (int)ARRAY_SIZE (pd->hi_addr); i++)
-	pd->hi_addr[i] = -1;
+    }
+
+  switch (op->pinfo & INSN_TYPE)
+    {
+    case INSN_BRANCH:
+      rec->insn_type = dis_branch;
+      break;
+    case INSN_CONDBRANCH:
+      rec->insn_type = dis_condbranch;
+      break;
+    case INSN_JSR:
+      rec->insn_type = dis_jsr;
+      break;
+    case INSN_DREF:
+      rec->insn_type = dis_dref;
+      break;
+    default:
+      rec->insn_type = dis_nonbranch;
+      break;
+    }
 
-      for (i = 0; i < info->symtab_size; i++)
-	if (strcmp (bfd_asymbol_name (info->symtab[i]), RISCV_GP_SYMBOL) == 0)
-	  pd->gp = bfd_asymbol_value (info->symtab[i]);
+  if (op->pinfo & INSN_DATA_SIZE)
+    {
+      int size = ((op->pinfo & INSN_DATA_SIZE)
+		  >> INSN_DATA_SIZE_SHIFT);
+      rec->data_size = 1 << (size - 1);
     }
+}
+
+/* fprintf_func that appends to a struct riscv_text.  */
+
+struct riscv_text
+{
+  char *buf;
+  size_t len, size;
+};
+
+static int
+riscv_text_printf (void *stream, const char *fmt, ...)
+{
+  struct riscv_text *text = stream;
+  va_list ap;
+  int n;
+
+  va_start (ap, fmt);
+  if (text->len < text->size)
+    n = vsnprintf (text->buf + text->len, text->size - text->len, fmt, ap);
   else
-    pd = info->private_data;
+    n = vsnprintf (NULL, 0, fmt, ap);
+  va_end (ap);
+  if (n > 0)
+    text->len += n;
+  return n;
+}
+
+/* Print the operands of REC from the cache, formatting them into the
+   cache first if needed.  Returns false if they have to be printed by
+   print_insn_args instead.  */
+
+static bool
+riscv_print_cached_args (struct riscv_private_data *pd,
+			 const struct riscv_insn_record *rec,
+			 disassemble_info *info)
+{
+  unsigned xlen = riscv_xlen (info);
+  struct riscv_cache_entry *entry = riscv_cache_slot (pd, rec->word, xlen);
+
+  if (entry->state == RISCV_CACHE_EMPTY
+      || entry->word != rec->word || entry->xlen != xlen
+      || entry->op != rec->op)
+    return false;
+
+  if (entry->state == RISCV_CACHE_OP)
+    {
+      struct riscv_text text = { entry->text, 0, sizeof (entry->text) };
+      fprintf_ftype print = info->fprintf_func;
+      void *stream = info->stream;
+
+      /* Branch and jump targets ('a', 'p', "Ca", "Cp") depend on the pc
+	 and go through print_address_func.  */
+      entry->state = RISCV_CACHE_NO_TEXT;
+      if (strchr (rec->op->args, 'a') != NULL
+	  || strchr (rec->op->args, 'p') != NULL)
+	return false;
+
+      entry->text[0] = '\0';
+      info->fprintf_func = riscv_text_printf;
+      info->stream = &text;
+      print_insn_args (rec->op->args, rec->word, rec->address, info);
+      info->fprintf_func = print;
+      info->stream = stream;
+      if (text.len < text.size)
+	entry->state = RISCV_CACHE_TEXT_VALID;
+    }
+
+  if (entry->state != RISCV_CACHE_TEXT_VALID)
+    return false;
+  (*info->fprintf_func) (info->stream, "%s", entry->text);
+  return true;
+}
+
+int
+riscv_print_insn_record (const struct riscv_insn_record *rec,
+			 disassemble_info *info)
+{
+  struct riscv_private_data *pd;
+
+  if (rec->op == NULL)
+    {
+      /* We did not find a match, so just print the instruction bits.  */
+      (*info->fprintf_func) (info->stream, "0x%llx",
+			     (unsigned long long)rec->word);
+      return rec->length;
+    }
+
+  pd = riscv_setup_info (info);
+  (*info->fprintf_func) (info->stream, "%s", rec->op->name);
+  if (pd->cache == NULL || !riscv_print_cached_args (pd, rec, info))
+    print_insn_args (rec->op->args, rec->word, rec->address, info);
+  if (rec->addr_comment)
+    {
+      info->target = rec->target;
+      (*info->fprintf_func) (info->stream, " # ");
+      (*info->print_address_func) (info->target, info);
+    }
+  return rec->length;
+}
+
+/* Print the RISC-V instruction at address MEMADDR in debugged memory,
+   on using INFO.  Returns length of the instruction, in bytes.
+   BIGENDIAN must be 1 if this is big-endian code, 0 if
+   this is little-endian code.  */
+
+static int
+riscv_disassemble_insn (bfd_vma memaddr, insn_t word, disassemble_info *info)
+{
+  struct riscv_private_data *pd = info->private_data;
+  struct riscv_insn_record rec;
 
-  insnlen = riscv_insn_length (word);
+  riscv_decode_insn (pd, riscv_xlen (info), memaddr, word, &rec);
 
   /* RISC-V instructions are always little-endian.  */
   info->endian_code = BFD_ENDIAN_LITTLE;
 
-  info->bytes_per_chunk = insnlen % 4 == 0 ? 4 : 2;
+  info->bytes_per_chunk = rec.length % 4 == 0 ? 4 : 2;
   info->bytes_per_line = 8;
   /* We don't support constant pools, so this must be code.  */
   info->display_endian = info->endian_code;
   info->insn_info_valid = 1;
   info->branch_delay_insns = 0;
-  info->data_size = 0;
-  info->insn_type = dis_nonbranch;
+  info->data_size = rec.data_size;
+  info->insn_type = rec.insn_type;
   info->target = 0;
   info->target2 = 0;
 
-  op = riscv_hash[OP_HASH_IDX (word)];
-  if (op != NULL)
-    {
-      unsigned xlen = 0;
-
-      /* If XLEN is not known, get its value from the ELF class.  */
-      if (info->mach == bfd_mach_riscv64)
-	xlen = 64;
-      else if (info->mach == bfd_mach_riscv32)
-	xlen = 32;
-      else if (info->section != NULL)
-	{
-	  Elf_Internal_Ehdr *ehdr = elf_elfheader (info->section->owner);
-	  xlen = ehdr->e_ident[EI_CLASS] == ELFCLASS64 ? 64 : 32;
-	}
-
-      for (; op->name; op++)
-	{
-	  /* Does the opcode match?  */
-	  if (! (op->match_func) (op, word))
-	    continue;
-	  /* Is this a pseudo-instruction and may we print it as such?  */
-	  if (no_aliases && (op->pinfo & INSN_ALIAS))
-	    continue;
-	  /* Is this instruction restricted to a certain value of XLEN?  */
-	  if ((op->xlen_requirement != 0) && (op->xlen_requirement != xlen))
-	    continue;
-
-	  /* It's a match.  */
-	  (*info->fprintf_func) (info->stream, "%s", op->name);
-	  print_insn_args (op->args, word, memaddr, info);
-
-	  /* Try to disassemble multi-instruction addressing sequences.  */
-	  if (pd->print_addr != (bfd_vma)-1)
-	    {
-	      info->target = pd->print_addr;
-	      (*info->fprintf_func) (info->stream, " # ");
-	      (*info->print_address_func) (info->target, info);
-	      pd->print_addr = -1;
-	    }
-
-	  /* Finish filling out insn_info fields.  */
-	  switch (op->pinfo & INSN_TYPE)
-	    {
-	    case INSN_BRANCH:
-	      info->insn_type = dis_branch;
-	      break;
-	    case INSN_CONDBRANCH:
-	      info->insn_type = dis_condbranch;
-	      break;
-	    case INSN_JSR:
-	      info->insn_type = dis_jsr;
-	      break;
-	    case INSN_DREF:
-	      info->insn_type = dis_dref;
-	      break;
-	    default:
-	      break;
-	    }
-
-	  if (op->pinfo & INSN_DATA_SIZE)
-	    {
-	      int size = ((op->pinfo & INSN_DATA_SIZE)
-			  >> INSN_DATA_SIZE_SHIFT);
-	      info->data_size = 1 << (size - 1);
-	    }
-
-	  return insnlen;
-	}
-    }
-
-  /* We did not find a match, so just print the instruction bits.  */
-  info->insn_type = dis_noninsn;
-  (*info->fprintf_func) (info->stream, "0x%llx", (unsigned long long)word);
-  return insnlen;
+  riscv_print_insn_record (&rec, info);
+  info->target = rec.target;
+  return rec.length;
 }
 
 int
@@ -569,14 +1255,7 @@ print_insn_riscv (bfd_vma memaddr, struct disassemble_info *info)
   bfd_vma n;
   int status;
 
-  if (info->disassembler_options != NULL)
-    {
-      parse_riscv_dis_options (info->disassembler_options);
-      /* Avoid repeatedly parsing the options.  */
-      info->disassembler_options = NULL;
-    }
-  else if (riscv_gpr_names == NULL)
-    set_default_riscv_dis_options ();
+  riscv_setup_info (info);
 
   /* Instructions are a sequence of 2-byte packets in little-endian order.  */
   for (n = 0; n < sizeof (insn) && n < riscv_insn_length (insn); n += 2)
@@ -597,29 +1276,437 @@ print_insn_riscv (bfd_vma memaddr, struct disassemble_info *info)
   return riscv_disassemble_insn (memaddr, insn, info);
 }
 
-disassembler_ftype
-riscv_get_disassembler (bfd *abfd)
+/* Decode from BUF + *OFFP until reaching STOP or filling COUNT records,
+   and advance *OFFP past the decoded instructions.  The last instruction
+   may extend past STOP, up to LEN.  Returns the number of records.  */
+
+static size_t
+riscv_decode_range (struct riscv_private_data *pd, unsigned xlen,
+		    bfd_vma address, const bfd_byte *buf, size_t len,
+		    size_t *offp, size_t stop,
+		    struct riscv_insn_record *records, size_t count)
 {
-  if (abfd)
+  size_t off = *offp, n = 0;
+
+  /* Same packet reading as print_insn_riscv, straight from BUF.  */
+  while (n < count && off < stop && off + 2 <= len)
     {
-      const struct elf_backend_data *ebd = get_elf_backend_data (abfd);
-      if (ebd)
-        {
-	  const char *sec_name = ebd->obj_attrs_section;
-	  if (bfd_get_section_by_name (abfd, sec_name) != NULL)
+      insn_t insn = 0;
+      size_t i;
+
+      for (i = 0; i < sizeof (insn) && i < riscv_insn_length (insn)
+		  && off + i + 2 <= len; i += 2)
+	insn |= ((insn_t) bfd_getl16 (buf + off + i)) << (8 * i);
+
+      riscv_decode_insn (pd, xlen, address + off, insn, &records[n]);
+      off += records[n].length;
+      n++;
+    }
+  *offp = off;
+  return n;
+}
+
+size_t
+riscv_disassemble_buffer (disassemble_info *info, bfd_vma address,
+			  const bfd_byte *buf, size_t len,
+			  struct riscv_insn_record *records, size_t count)
+{
+  struct riscv_private_data *pd = riscv_setup_info (info);
+  size_t off = 0;
+
+  return riscv_decode_range (pd, riscv_xlen (info), address, buf, len,
+			     &off, len, records, count);
+}
+
+/* Instruction boundary scan.  An instruction's length only depends on
+   the low bits of its first halfword, so the boundaries of a buffer can
+   be found without decoding it.  With only 16- and 32-bit instructions,
+   halfword I starts an instruction unless halfword I-1 started a 32-bit
+   one: S[I] = !S[I-1] | C[I-1], where C marks halfwords that would be a
+   16-bit instruction.  So every halfword after a C halfword is a start,
+   and from there starts alternate until the next such anchor.  That is a
+   set/reset latch on the anchor parity, which one 64-bit addition
+   computes for 64 halfwords at once.  Blocks with 48- or 64-bit
+   instructions, and the tail, are walked one halfword at a time.  */
+
+/* Classify the 64 halfwords at P: set bit I of *COMPRESSED if halfword I
+   would be a 16-bit instruction, and bit I of *LONG if it would start an
+   instruction of 48 bits or more.  */
+
+static void
+riscv_classify_halfwords (const bfd_byte *p, uint64_t *compressed,
+			  uint64_t *lng)
+{
+#ifdef __SSE2__
+  const __m128i m3 = _mm_set1_epi16 (0x3);
+  const __m128i m1f = _mm_set1_epi16 (0x1f);
+  const __m128i m7f = _mm_set1_epi16 (0x7f);
+  const __m128i ones = _mm_set1_epi16 (-1);
+  uint64_t c = 0, l = 0;
+  __m128i v, rvc[2], big[2];
+  int i, j;
+
+  for (i = 0; i < 4; i++)
+    {
+      for (j = 0; j < 2; j++)
+	{
+	  v = _mm_loadu_si128 ((const __m128i *) (p + 32 * i + 16 * j));
+	  /* 16-bit: low two bits not 11, or the low seven bits all ones.  */
+	  rvc[j] = _mm_xor_si128 (_mm_cmpeq_epi16 (_mm_and_si128 (v, m3), m3),
+				  ones);
+	  rvc[j] = _mm_or_si128 (rvc[j],
+				 _mm_cmpeq_epi16 (_mm_and_si128 (v, m7f), m7f));
+	  /* 48 bits or more: low five bits all ones, but not the above.  */
+	  big[j] = _mm_andnot_si128 (rvc[j],
+				     _mm_cmpeq_epi16 (_mm_and_si128 (v, m1f),
+						      m1f));
+	}
+      c |= ((uint64_t) (_mm_movemask_epi8 (_mm_packs_epi16 (rvc[0], rvc[1]))
+			& 0xffff) << (16 * i));
+      l |= ((uint64_t) (_mm_movemask_epi8 (_mm_packs_epi16 (big[0], big[1]))
+			& 0xffff) << (16 * i));
+    }
+  *compressed = c;
+  *lng = l;
+#else
+  uint64_t c = 0, l = 0;
+  int i;
+
+  for (i = 63; i >= 0; i--)
+    {
+      unsigned int h = p[2 * i];
+      unsigned int rvc = ((h & 0x3) != 0x3) | ((h & 0x7f) == 0x7f);
+
+      c = (c << 1) | rvc;
+      l = (l << 1) | (~rvc & ((h & 0x1f) == 0x1f));
+    }
+  *compressed = c;
+  *lng = l;
+#endif
+}
+
+/* Instruction starts in a block of 64 halfwords without long
+   instructions, given the 16-bit mask C and whether halfword 0 is a
+   start (S0).  */
+
+static uint64_t
+riscv_block_starts (uint64_t c, bool s0)
+{
+  const uint64_t even = 0x5555555555555555ull;
+  /* Anchors: halfwords after a 16-bit one, and halfword 0.  */
+  uint64_t anchors = (c << 1) | 1;
+  /* The latch is set at even anchors and reset at odd ones; halfword 0
+     counts as even if it is a start.  */
+  uint64_t set = (anchors & even & ~(uint64_t) 1) | (s0 ? 1 : 0);
+  uint64_t keep = ~(anchors & ~set);
+  /* The carry of SET runs through KEEP up to the next reset.  */
+  uint64_t latch = keep & (~(keep + set) | set);
+
+  return ~(latch ^ even);
+}
+
+void
+riscv_scan_insn_boundaries (const bfd_byte *buf, size_t len,
+			    uint64_t *starts)
+{
+  size_t num = len / 2, base, i;
+  /* Halfwords of the current instruction still to pass.  */
+  unsigned int skip = 0;
+
+  for (base = 0; base < num; base += 64)
+    {
+      size_t n = num - base < 64 ? num - base : 64;
+      uint64_t bits = 0, c, l;
+
+      if (n == 64 && skip <= 1)
+	{
+	  riscv_classify_halfwords (buf + 2 * base, &c, &l);
+	  if (l == 0)
 	    {
-	      obj_attribute *attr = elf_known_obj_attributes_proc (abfd);
-	      unsigned int Tag_a = Tag_RISCV_priv_spec;
-	      unsigned int Tag_b = Tag_RISCV_priv_spec_minor;
-	      unsigned int Tag_c = Tag_RISCV_priv_spec_revision;
-	      riscv_get_priv_spec_class_from_numbers (attr[Tag_a].i,
-						      attr[Tag_b].i,
-						      attr[Tag_c].i,
-						      &default_priv_spec);
+	      bits = riscv_block_starts (c, skip == 0);
+	      skip = (bits >> 63) & ~(c >> 63) & 1;
+	      starts[base / 64] = bits;
+	      continue;
 	    }
-        }
+	}
+
+      for (i = 0; i < n; i++)
+	if (skip != 0)
+	  skip--;
+	else
+	  {
+	    bits |= (uint64_t) 1 << i;
+	    skip = riscv_insn_length (bfd_getl16 (buf + 2 * (base + i))) / 2 - 1;
+	  }
+      starts[base / 64] = bits;
+    }
+}
+
+/* Parallel decoding.  The buffer is split into chunks at function
+   symbols and the chunks are decoded concurrently, each with a copy of
+   the private data that has no lui/auipc history.  hi_addr is the only
+   state carried from one instruction to the next, and every read of it
+   clears it, so a chunk decoded this way is exact as long as it starts
+   where the previous chunk ended and every register in its hi_live_in
+   was clear on entry.  A serial pass then walks the chunks in address
+   order with the real hi_addr state, keeps the chunks that qualify and
+   decodes the others again, so the records are exactly those
+   riscv_disassemble_buffer would produce.  */
+
+struct riscv_chunk
+{
+  /* Byte offsets into the buffer: where decoding starts, where it stops,
+     and where the last instruction actually ended.  */
+  size_t start, stop, end;
+  struct riscv_private_data pd;
+  struct riscv_insn_record *records;
+  size_t num_records, max_records;
+};
+
+struct riscv_chunk_job
+{
+  struct riscv_chunk *chunks;
+  size_t num_chunks, first, step;
+  unsigned xlen;
+  bfd_vma address;
+  const bfd_byte *buf;
+  size_t len;
+};
+
+static void *
+riscv_decode_chunks (void *arg)
+{
+  struct riscv_chunk_job *job = arg;
+  size_t i;
+
+  for (i = job->first; i < job->num_chunks; i += job->step)
+    {
+      struct riscv_chunk *chunk = &job->chunks[i];
+      size_t off = chunk->start;
+
+      while (off < chunk->stop && off + 2 <= job->len)
+	{
+	  if (chunk->num_records == chunk->max_records)
+	    {
+	      chunk->max_records = chunk->max_records * 2
+				   + (chunk->stop - chunk->start) / 4 + 16;
+	      chunk->records = xrealloc (chunk->records,
+					 chunk->max_records
+					 * sizeof (*chunk->records));
+	    }
+	  chunk->num_records
+	    += riscv_decode_range (&chunk->pd, job->xlen, job->address,
+				   job->buf, job->len, &off, chunk->stop,
+				   chunk->records + chunk->num_records,
+				   chunk->max_records - chunk->num_records);
+	}
+      chunk->end = off;
+    }
+  return NULL;
+}
+
+static int
+compare_offsets (const void *a, const void *b)
+{
+  size_t x = *(const size_t *) a, y = *(const size_t *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* Store in STARTS the offsets of the chunks BUF[0..LEN) at ADDRESS is
+   split into, aiming for NUM_CHUNKS chunks of similar size that all
+   start at a function symbol of INFO.  Symbols that are not instruction
+   boundaries according to BOUNDS (riscv_scan_insn_boundaries) are
+   skipped.  Returns the number of chunks.  */
+
+static size_t
+riscv_split_chunks (disassemble_info *info, bfd_vma address, size_t len,
+		    const uint64_t *bounds, size_t num_chunks, size_t *starts)
+{
+  size_t *syms = xmalloc ((info->symtab_size + 1) * sizeof (*syms));
+  size_t num_syms = 0, n = 0, i, min_size;
+
+  for (i = 0; i < (size_t) info->symtab_size; i++)
+    {
+      asymbol *sym = info->symtab[i];
+      bfd_vma value = bfd_asymbol_value (sym);
+
+      if ((sym->flags & BSF_FUNCTION) != 0
+	  && (info->section == NULL
+	      || bfd_asymbol_section (sym) == info->section)
+	  && value > address && value - address + 2 <= len
+	  && (value - address) % 2 == 0
+	  && ((bounds[(value - address) / 128]
+	       >> ((value - address) / 2 % 64)) & 1) != 0)
+	syms[num_syms++] = value - address;
+    }
+  qsort (syms, num_syms, sizeof (*syms), compare_offsets);
+
+  min_size = len / num_chunks;
+  starts[n++] = 0;
+  for (i = 0; i < num_syms && n < num_chunks; i++)
+    if (syms[i] > starts[n - 1] && syms[i] - starts[n - 1] >= min_size)
+      starts[n++] = syms[i];
+  free (syms);
+  return n;
+}
+
+size_t
+riscv_disassemble_buffer_parallel (disassemble_info *info, bfd_vma address,
+				   const bfd_byte *buf, size_t len,
+				   struct riscv_insn_record *records,
+				   size_t count, int num_threads)
+{
+  struct riscv_private_data *pd = riscv_setup_info (info);
+  struct riscv_private_data cur;
+  struct riscv_chunk *chunks;
+  struct riscv_chunk_job *jobs;
+  uint64_t *bounds;
+  size_t *starts, num_chunks, i, off, n;
+  unsigned xlen = riscv_xlen (info);
+  int r;
+
+  if (num_threads <= 1)
+    return riscv_disassemble_buffer (info, address, buf, len, records, count);
+
+  /* A few chunks per thread evens out functions of different sizes.  */
+  bounds = xmalloc (((len / 2 + 63) / 64 + 1) * sizeof (*bounds));
+  riscv_scan_insn_boundaries (buf, len, bounds);
+  starts = xmalloc (num_threads * 4 * sizeof (*starts));
+  num_chunks = riscv_split_chunks (info, address, len, bounds,
+				   num_threads * 4, starts);
+  free (bounds);
+  if (num_chunks <= 1)
+    {
+      free (starts);
+      return riscv_disassemble_buffer (info, address, buf, len,
+				       records, count);
+    }
+
+  chunks = xcalloc (num_chunks, sizeof (*chunks));
+  for (i = 0; i < num_chunks; i++)
+    {
+      chunks[i].start = starts[i];
+      chunks[i].stop = i + 1 < num_chunks ? starts[i + 1] : len;
+      chunks[i].pd = *pd;
+      for (r = 0; r <= OP_MASK_RD; r++)
+	chunks[i].pd.hi_addr[r] = -1;
+      chunks[i].pd.hi_live_in = 0;
+      chunks[i].pd.hi_touched = 0;
+      /* The cache is not shared between threads.  */
+      chunks[i].pd.cache = NULL;
+    }
+  free (starts);
+
+  if ((size_t) num_threads > num_chunks)
+    num_threads = num_chunks;
+  jobs = xmalloc (num_threads * sizeof (*jobs));
+  for (r = 0; r < num_threads; r++)
+    {
+      jobs[r].chunks = chunks;
+      jobs[r].num_chunks = num_chunks;
+      jobs[r].first = r;
+      jobs[r].step = num_threads;
+      jobs[r].xlen = xlen;
+      jobs[r].address = address;
+      jobs[r].buf = buf;
+      jobs[r].len = len;
+    }
+
+#ifdef HAVE_PTHREAD_H
+  {
+    pthread_t *threads = xmalloc (num_threads * sizeof (*threads));
+    int started;
+
+    for (started = 1; started < num_threads; started++)
+      if (pthread_create (&threads[started], NULL, riscv_decode_chunks,
+			  &jobs[started]) != 0)
+	break;
+    riscv_decode_chunks (&jobs[0]);
+    for (r = 1; r < started; r++)
+      pthread_join (threads[r], NULL);
+    /* Chunks of threads that could not be started.  */
+    for (r = started; r < num_threads; r++)
+      riscv_decode_chunks (&jobs[r]);
+    free (threads);
+  }
+#else
+  for (r = 0; r < num_threads; r++)
+    riscv_decode_chunks (&jobs[r]);
+#endif
+  free (jobs);
+
+  /* Merge in address order, carrying the real hi_addr state in CUR.  */
+  cur = *pd;
+  off = 0;
+  n = 0;
+  for (i = 0; i < num_chunks && n < count; i++)
+    {
+      struct riscv_chunk *chunk = &chunks[i];
+      bool keep = (chunk->start == off
+		   && chunk->num_records <= count - n);
+
+      for (r = 0; keep && r <= OP_MASK_RD; r++)
+	if ((chunk->pd.hi_live_in & (1u << r)) != 0
+	    && cur.hi_addr[r] != (bfd_vma)-1)
+	  keep = false;
+
+      if (keep)
+	{
+	  memcpy (records + n, chunk->records,
+		  chunk->num_records * sizeof (*records));
+	  n += chunk->num_records;
+	  off = chunk->end;
+	  for (r = 0; r <= OP_MASK_RD; r++)
+	    if ((chunk->pd.hi_touched & (1u << r)) != 0)
+	      cur.hi_addr[r] = chunk->pd.hi_addr[r];
+	}
+      else
+	n += riscv_decode_range (&cur, xlen, address, buf, len, &off,
+				 chunk->stop, records + n, count - n);
+      free (chunk->records);
     }
-   return print_insn_riscv;
+  for (; i < num_chunks; i++)
+    free (chunks[i].records);
+  free (chunks);
+
+  memcpy (pd->hi_addr, cur.hi_addr, sizeof (pd->hi_addr));
+  return n;
+}
+
+void
+riscv_set_decode_cache (disassemble_info *info, unsigned int entries)
+{
+  struct riscv_private_data *pd = riscv_setup_info (info);
+  unsigned int size = 1;
+
+  free (pd->cache);
+  pd->cache = NULL;
+  pd->cache_mask = 0;
+  if (entries == 0)
+    return;
+
+  if (entries > RISCV_CACHE_MAX_ENTRIES)
+    entries = RISCV_CACHE_MAX_ENTRIES;
+  while (size < entries)
+    size *= 2;
+  pd->cache = xcalloc (size, sizeof (*pd->cache));
+  pd->cache_mask = size - 1;
+}
+
+/* Each disassemble_info reads the privileged spec from the owner of its
+   section (riscv_get_private_data); the one of ABFD is only the default
+   for those that have no section or whose object records none.  */
+
+disassembler_ftype
+riscv_get_disassembler (bfd *abfd)
+{
+  enum riscv_spec_class priv_spec = riscv_elf_priv_spec (abfd);
+
+  riscv_ensure_tables ();
+  if (priv_spec != PRIV_SPEC_CLASS_NONE)
+    __atomic_store_n (&riscv_default_priv_spec, priv_spec, __ATOMIC_RELAXED);
+  return print_insn_riscv;
 }
 
 /* Prevent use of the fake labels that are generated as part of the DWARF
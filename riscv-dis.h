@@ -0,0 +1,171 @@
+/* RISC-V disassembler batch interface
+   Copyright (C) 2011-2021 Free Software Foundation, Inc.
+
+   This file is part of the GNU opcodes library.
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   It is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+   or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+   License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING3. If not,
+   see <http://www.gnu.org/licenses/>.  */
+
+#ifndef RISCV_DIS_H
+#define RISCV_DIS_H
+
+#include "dis-asm.h"
+#include "opcode/riscv.h"
+
+/* One decoded instruction.  riscv_disassemble_buffer fills these without
+   printing anything; riscv_print_insn_record turns one back into the
+   text print_insn_riscv would have produced.  */
+
+/* What the address of a " # address" comment is relative to.  */
+
+enum riscv_addr_base
+{
+  /* An earlier lui/auipc.  */
+  RISCV_ADDR_HI,
+  /* The global pointer.  */
+  RISCV_ADDR_GP,
+  /* The thread pointer; the address is only the offset.  */
+  RISCV_ADDR_TP,
+  /* x0; the address is only the offset.  */
+  RISCV_ADDR_ZERO
+};
+
+struct riscv_insn_record
+{
+  bfd_vma address;
+  insn_t word;
+  unsigned int length;
+  /* The matching riscv_opcodes entry, or NULL if nothing matched.  */
+  const struct riscv_opcode *op;
+  /* Raw register fields of WORD.  */
+  unsigned char rd, rs1, rs2, rs3;
+  enum dis_insn_type insn_type;
+  /* Size of the memory access in bytes, or 0.  */
+  unsigned char data_size;
+  /* Branch or jump target, or the address formed from the base
+     register of a load, store or addi (see ADDR_COMMENT), or 0.  */
+  bfd_vma target;
+  /* Set if TARGET was formed from the base register and is printed as
+     a " # address" comment; ADDR_BASE says what the base was.  */
+  bool addr_comment;
+  enum riscv_addr_base addr_base;
+};
+
+/* Kinds of decoded operands.  */
+
+enum riscv_operand_kind
+{
+  /* Integer register; VALUE is its number.  */
+  RISCV_OPERAND_GPR,
+  /* Floating-point register; VALUE is its number.  */
+  RISCV_OPERAND_FPR,
+  /* Immediate, printed in decimal.  */
+  RISCV_OPERAND_IMM,
+  /* Immediate printed in hex: upper immediates and shift amounts.  */
+  RISCV_OPERAND_UIMM,
+  /* Branch or jump target address.  */
+  RISCV_OPERAND_ADDRESS,
+  /* CSR number.  */
+  RISCV_OPERAND_CSR,
+  /* Floating-point rounding mode (the rm field).  */
+  RISCV_OPERAND_ROUNDING,
+  /* Fence predecessor or successor set.  */
+  RISCV_OPERAND_FENCE,
+  /* Undefined operand letter; VALUE is the letter.  Always last.  */
+  RISCV_OPERAND_INVALID
+};
+
+struct riscv_operand
+{
+  enum riscv_operand_kind kind;
+  /* Offset of the operand's letter in the opcode's args string.  */
+  unsigned char arg;
+  bfd_signed_vma value;
+};
+
+#define RISCV_MAX_OPERANDS 8
+
+/* Constraints the match_func of a riscv_opcodes entry puts on a word
+   beyond its match and mask bits.  */
+
+#define RISCV_MATCH_RD_NONZERO		  (1u << 0)
+#define RISCV_MATCH_RD_ZERO		  (1u << 1)
+#define RISCV_MATCH_RD_SP		  (1u << 2)
+#define RISCV_MATCH_RD_NOT_SP		  (1u << 3)
+#define RISCV_MATCH_RS1_EQ_RS2		  (1u << 4)
+#define RISCV_MATCH_CRS2_NONZERO	  (1u << 5)
+#define RISCV_MATCH_LUI_IMM_NONZERO	  (1u << 6)
+#define RISCV_MATCH_ADDI4SPN_IMM_NONZERO  (1u << 7)
+#define RISCV_MATCH_CI_IMM_NONZERO	  (1u << 8)
+#define RISCV_MATCH_CI_IMM_ZERO		  (1u << 9)
+/* The entry never matches (macros).  */
+#define RISCV_MATCH_NEVER		  (1u << 10)
+/* The match_func is not one riscv-opc.c knows; call it.  */
+#define RISCV_MATCH_FUNC		  (1u << 11)
+
+extern unsigned int riscv_match_constraints (const struct riscv_opcode *op);
+extern unsigned int riscv_match_failures (insn_t insn);
+
+/* Decode the instructions in BUF[0..LEN), which is mapped at ADDRESS,
+   into at most COUNT RECORDS, using the options, machine and symbols of
+   INFO.  Returns the number of records filled; decoding stops early at
+   the end of the buffer.  */
+
+extern size_t riscv_disassemble_buffer (disassemble_info *info,
+					bfd_vma address,
+					const bfd_byte *buf, size_t len,
+					struct riscv_insn_record *records,
+					size_t count);
+
+/* Like riscv_disassemble_buffer, but split BUF at the function symbols
+   of INFO and decode the pieces on up to NUM_THREADS threads.  The
+   records are the same as riscv_disassemble_buffer would produce.  */
+
+extern size_t riscv_disassemble_buffer_parallel (disassemble_info *info,
+						 bfd_vma address,
+						 const bfd_byte *buf,
+						 size_t len,
+						 struct riscv_insn_record *records,
+						 size_t count, int num_threads);
+
+/* Find where the instructions of BUF[0..LEN) start when it is decoded
+   from the beginning, without decoding it.  Sets bit I % 64 of
+   STARTS[I / 64] if halfword I starts an instruction; STARTS must have
+   room for (LEN / 2 + 63) / 64 words.  */
+
+extern void riscv_scan_insn_boundaries (const bfd_byte *buf, size_t len,
+					uint64_t *starts);
+
+/* Decode the operands of REC, in the order they are printed, into
+   OPERANDS, which has room for RISCV_MAX_OPERANDS entries.  Returns the
+   number of operands; 0 if REC did not match an opcode.  */
+
+extern unsigned int riscv_decode_operands (const struct riscv_insn_record *rec,
+					   struct riscv_operand *operands);
+
+/* Give INFO a cache of ENTRIES (rounded up to a power of two, at most
+   2^20) decoded instruction words, so repeated words skip opcode matching
+   and, when their operands do not depend on the pc, operand formatting.
+   ENTRIES 0 frees the cache; do that before freeing
+   INFO->private_data.  */
+
+extern void riscv_set_decode_cache (disassemble_info *info,
+				    unsigned int entries);
+
+/* Print REC through INFO->fprintf_func.  Returns its length in bytes.  */
+
+extern int riscv_print_insn_record (const struct riscv_insn_record *rec,
+				    disassemble_info *info);
+
+#endif /* RISCV_DIS_H */
@@ -0,0 +1,270 @@
+"""
+
+Generate the custom-instruction parts of riscv-opc.h, riscv-opc.c,
+ISDOpcodes.h and RISCVInstrInfo.td from riscv-custom.spec.
+
+Each generated part sits between a "riscv-gen: begin <region>" and a
+"riscv-gen: end <region>" comment line; everything outside those lines
+is left alone.  The riscv_opcodes rows stay where the region is, since
+their position in the table decides alias priority; the disassembler
+builds its bucketed decode table from riscv_opcodes at first use.
+
+usage: python3 riscv-gen.py [--check]
+
+"""
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+OPCODES = {
+    "OP": 0x33,
+    "OP_32": 0x3b,
+    "CUSTOM_0": 0x0b,
+    "CUSTOM_1": 0x2b,
+    "CUSTOM_2": 0x5b,
+    "CUSTOM_3": 0x7b,
+}
+
+# field: (shift, width)
+FIELDS = {
+    "opcode": (0, 7),
+    "funct3": (12, 3),
+    "funct2": (25, 2),
+    "funct7": (25, 7),
+}
+
+FORMATS = {
+    # format: (function field, register operands)
+    "r": ("funct7", ["rd", "rs1", "rs2"]),
+    "r4": ("funct2", ["rd", "rs1", "rs2", "rs3"]),
+}
+
+KEYS = ("format", "opcode", "funct3", "funct7", "funct2", "operands",
+        "class", "isd", "td-class", "sched", "pattern")
+
+
+def fail(msg):
+    sys.exit("riscv-gen.py: " + msg)
+
+
+def parse_spec(path):
+    insns = []
+    with open(path) as f:
+        for lineno, line in enumerate(f, 1):
+            where = "%s:%d" % (os.path.basename(path), lineno)
+            text = line.split("#", 1)[0].rstrip()
+            if not text:
+                continue
+            if not text[0].isspace():
+                words = text.split()
+                if len(words) != 2 or words[0] != "insn":
+                    fail(where + ": expected 'insn <name>'")
+                insns.append({"name": words[1], "where": where})
+                continue
+            if not insns:
+                fail(where + ": field outside an insn entry")
+            key, _, value = text.strip().partition(" ")
+            if key not in KEYS:
+                fail(where + ": unknown key '%s'" % key)
+            insns[-1][key] = value.strip()
+    for insn in insns:
+        check_insn(insn)
+    return insns
+
+
+def field_value(insn, key):
+    shift, width = FIELDS[key]
+    if key == "opcode":
+        if insn["opcode"] not in OPCODES:
+            fail("%s: unknown opcode %s" % (insn["where"], insn["opcode"]))
+        value = OPCODES[insn["opcode"]]
+    else:
+        if not re.fullmatch(r"0b[01]+", insn[key]):
+            fail("%s: %s must be written as 0b..." % (insn["where"], key))
+        value = int(insn[key], 2)
+    if value >> width:
+        fail("%s: %s does not fit in %d bits" % (insn["where"], key, width))
+    return value, shift, width
+
+
+def check_insn(insn):
+    for key in ("format", "opcode", "funct3", "operands", "class", "isd",
+                "td-class", "sched"):
+        if key not in insn:
+            fail("%s: missing '%s'" % (insn["where"], key))
+    if insn["format"] not in FORMATS:
+        fail("%s: unknown format %s" % (insn["where"], insn["format"]))
+    funct, regs = FORMATS[insn["format"]]
+    if funct not in insn:
+        fail("%s: format %s needs '%s'" % (insn["where"], insn["format"],
+                                           funct))
+    match = mask = 0
+    for key in ("opcode", "funct3", funct):
+        value, shift, width = field_value(insn, key)
+        match |= value << shift
+        mask |= ((1 << width) - 1) << shift
+    insn["match"], insn["mask"] = match, mask
+    insn["regs"] = regs
+    if len(insn["sched"].split()) != len(regs):
+        fail("%s: sched needs one write and %d reads"
+             % (insn["where"], len(regs) - 1))
+    if "pattern" in insn and "->" not in insn["pattern"]:
+        fail("%s: pattern must be '<dag> -> <result>'" % insn["where"])
+
+
+def check_overlap(insns, header):
+    """Warn about existing encodings a custom one can be confused with."""
+    known = {}
+    for m in re.finditer(r"^#define (MATCH|MASK)_(\w+)\s+(0x[0-9a-f]+)\s*$",
+                         header, re.M):
+        known.setdefault(m.group(2), {})[m.group(1)] = int(m.group(3), 16)
+    custom = set(insn["name"].upper() for insn in insns)
+    for insn in insns:
+        for name, enc in sorted(known.items()):
+            if name in custom or len(enc) != 2:
+                continue
+            if (insn["match"] ^ enc["MATCH"]) & insn["mask"] & enc["MASK"]:
+                continue
+            sys.stderr.write("riscv-gen.py: warning: %s overlaps %s\n"
+                             % (insn["name"], name.lower()))
+
+
+def gen_match_mask(insns):
+    out = []
+    for insn in insns:
+        name = insn["name"].upper()
+        out.append("#define MATCH_%s 0x%x" % (name, insn["match"]))
+        out.append("#define MASK_%s  0x%x" % (name, insn["mask"]))
+    return out
+
+
+def gen_declare_insn(insns):
+    return ["DECLARE_INSN(%s, MATCH_%s, MASK_%s)"
+            % (insn["name"], insn["name"].upper(), insn["name"].upper())
+            for insn in insns]
+
+
+def gen_opcodes(insns):
+    out = []
+    for insn in insns:
+        name = insn["name"].upper()
+        out.append('{%-14s 0, INSN_CLASS_%s, %-12s MATCH_%s, MASK_%s, '
+                   'match_opcode, 0 },'
+                   % ('"%s",' % insn["name"], insn["class"],
+                      '"%s",' % insn["operands"], name, name))
+    return out
+
+
+def gen_isd(insns):
+    out = []
+    for insn in insns:
+        out.append("  // " + insn["isd"])
+        out.append("  %s," % insn["name"].upper())
+    return out
+
+
+def gen_td_classes(insns):
+    out = []
+    seen = {}
+    for insn in insns:
+        key = (insn["format"], insn["opcode"])
+        cls = insn["td-class"]
+        if cls in seen:
+            if seen[cls] != key:
+                fail("%s: td-class %s is used with another format or opcode"
+                     % (insn["where"], cls))
+            continue
+        seen[cls] = key
+        funct, _ = FORMATS[insn["format"]]
+        width = FIELDS[funct][1]
+        ins = ", ".join("GPR:$" + r for r in insn["regs"][1:])
+        asm = ", ".join("$" + r for r in insn["regs"])
+        head = "    : %s<" % ("RVInstR4" if insn["format"] == "r4"
+                                else "RVInstR")
+        indent = " " * len(head)
+        out.append("let hasSideEffects = 0, mayLoad = 0, mayStore = 0 in")
+        out.append("class %s<bits<%d> %s, bits<3> funct3, string opcodestr>"
+                   % (cls, width, funct))
+        out.append("%s%s, funct3, OPC_%s, (outs GPR:$rd),"
+                   % (head, funct, insn["opcode"]))
+        out.append("%s(ins %s)," % (indent, ins))
+        out.append('%sopcodestr, "%s">;' % (indent, asm))
+    return out
+
+
+def gen_td_defs(insns):
+    out = []
+    for insn in insns:
+        funct, _ = FORMATS[insn["format"]]
+        out.append('def %s : %s<%s, %s, "%s">, Sched<[%s]>;'
+                   % (insn["name"].upper(), insn["td-class"], insn[funct],
+                      insn["funct3"], insn["name"],
+                      ", ".join(insn["sched"].split())))
+    return out
+
+
+def gen_td_patterns(insns):
+    out = []
+    for insn in insns:
+        if "pattern" not in insn:
+            continue
+        dag, result = (s.strip() for s in insn["pattern"].split("->"))
+        out.append("def : Pat<%s," % dag)
+        out.append("          %s>;" % result)
+    return out
+
+
+# file: [(region, generator)]
+TARGETS = [
+    ("riscv-opc.h", [("match-mask", gen_match_mask),
+                     ("declare-insn", gen_declare_insn)]),
+    ("riscv-opc.c", [("opcodes", gen_opcodes)]),
+    ("ISDOpcodes.h", [("isd", gen_isd)]),
+    ("RISCVInstrInfo.td", [("td-classes", gen_td_classes),
+                           ("td-defs", gen_td_defs),
+                           ("td-patterns", gen_td_patterns)]),
+]
+
+
+def replace_region(text, path, region, lines):
+    begin = re.search(r"^.*riscv-gen: begin %s\b.*\n" % region, text, re.M)
+    end = re.search(r"^.*riscv-gen: end %s\b.*\n" % region, text, re.M)
+    if not begin or not end or end.start() < begin.end():
+        fail("%s: no '%s' region" % (path, region))
+    body = "".join(line + "\n" for line in lines)
+    return text[:begin.end()] + body + text[end.start():]
+
+
+def main():
+    check = sys.argv[1:] == ["--check"]
+    if sys.argv[1:] and not check:
+        sys.exit(__doc__.strip().splitlines()[-1])
+
+    insns = parse_spec(os.path.join(HERE, "riscv-custom.spec"))
+    stale = []
+    for name, regions in TARGETS:
+        path = os.path.join(HERE, name)
+        with open(path, newline="") as f:
+            old = f.read()
+        new = old
+        for region, gen in regions:
+            new = replace_region(new, name, region, gen(insns))
+        if name == "riscv-opc.h":
+            check_overlap(insns, new)
+        if new == old:
+            continue
+        stale.append(name)
+        if not check:
+            with open(path, "w", newline="") as f:
+                f.write(new)
+
+    if check and stale:
+        fail("out of date: " + ", ".join(stale))
+    for name in stale:
+        print("updated " + name)
+
+
+if __name__ == "__main__":
+    main()
@@ -22,6 +22,7 @@
 
 #include "sysdep.h"
 #include "opcode/riscv.h"
+#include "riscv-dis.h"
 #include <stdio.h>
 
 /* Register names used by gas and objdump.  */
@@ -200,6 +201,73 @@ match_srxi_as_c_srxi (const struct riscv_opcode *op, insn_t insn)
   return match_opcode (op, insn) && EXTRACT_CITYPE_IMM (insn) != 0;
 }
 
+/* The match functions above as data: each one is match_opcode plus the
+   RISCV_MATCH_* constraints listed here.  */
+
+static const struct
+{
+  int (*match_func) (const struct riscv_opcode *, insn_t);
+  unsigned int constraints;
+} riscv_match_funcs[] =
+{
+  { match_opcode, 0 },
+  { match_never, RISCV_MATCH_NEVER },
+  { match_rs1_eq_rs2, RISCV_MATCH_RS1_EQ_RS2 },
+  { match_rd_nonzero, RISCV_MATCH_RD_NONZERO },
+  { match_c_add, RISCV_MATCH_RD_NONZERO | RISCV_MATCH_CRS2_NONZERO },
+  { match_c_add_with_hint, RISCV_MATCH_CRS2_NONZERO },
+  { match_c_nop, RISCV_MATCH_RD_ZERO },
+  { match_c_addi16sp, RISCV_MATCH_RD_SP },
+  { match_c_lui, (RISCV_MATCH_RD_NONZERO | RISCV_MATCH_RD_NOT_SP
+		  | RISCV_MATCH_LUI_IMM_NONZERO) },
+  { match_c_lui_with_hint, (RISCV_MATCH_RD_NOT_SP
+			    | RISCV_MATCH_LUI_IMM_NONZERO) },
+  { match_c_addi4spn, RISCV_MATCH_ADDI4SPN_IMM_NONZERO },
+  { match_c_slli, RISCV_MATCH_CI_IMM_NONZERO },
+  { match_slli_as_c_slli, (RISCV_MATCH_RD_NONZERO
+			   | RISCV_MATCH_CI_IMM_NONZERO) },
+  { match_c_slli64, RISCV_MATCH_CI_IMM_ZERO },
+  { match_srxi_as_c_srxi, RISCV_MATCH_CI_IMM_NONZERO },
+};
+
+/* Return the constraints OP->match_func checks on top of OP's match and
+   mask bits, or RISCV_MATCH_FUNC if it is not a known match function.  */
+
+unsigned int
+riscv_match_constraints (const struct riscv_opcode *op)
+{
+  size_t i;
+
+  for (i = 0; i < ARRAY_SIZE (riscv_match_funcs); i++)
+    if (riscv_match_funcs[i].match_func == op->match_func)
+      return riscv_match_funcs[i].constraints;
+  return RISCV_MATCH_FUNC;
+}
+
+/* Return the constraints INSN does not meet.  An entry whose constraints
+   do not intersect the result matches INSN if its match and mask bits
+   do.  */
+
+unsigned int
+riscv_match_failures (insn_t insn)
+{
+  unsigned int rd = (insn & MASK_RD) >> OP_SH_RD;
+  unsigned int rs1 = (insn & MASK_RS1) >> OP_SH_RS1;
+  unsigned int rs2 = (insn & MASK_RS2) >> OP_SH_RS2;
+
+  return (RISCV_MATCH_NEVER
+	  | (rd == 0 ? RISCV_MATCH_RD_NONZERO : RISCV_MATCH_RD_ZERO)
+	  | (rd == X_SP ? RISCV_MATCH_RD_NOT_SP : RISCV_MATCH_RD_SP)
+	  | (rs1 != rs2 ? RISCV_MATCH_RS1_EQ_RS2 : 0)
+	  | ((insn & MASK_CRS2) == 0 ? RISCV_MATCH_CRS2_NONZERO : 0)
+	  | (EXTRACT_CITYPE_LUI_IMM (insn) == 0
+	     ? RISCV_MATCH_LUI_IMM_NONZERO : 0)
+	  | (EXTRACT_CIWTYPE_ADDI4SPN_IMM (insn) == 0
+	     ? RISCV_MATCH_ADDI4SPN_IMM_NONZERO : 0)
+	  | (EXTRACT_CITYPE_IMM (insn) == 0
+	     ? RISCV_MATCH_CI_IMM_NONZERO : RISCV_MATCH_CI_IMM_ZERO));
+}
+
 const struct riscv_opcode riscv_opcodes[] =
 {
 /* name, xlen, isa, operands, match, mask, match_func, pinfo.  */
@@ -288,8 +356,9 @@ const struct riscv_opcode riscv_opcodes[] =
 {"add",         0, INSN_CLASS_I, "d,s,t,1",   MATCH_ADD, MASK_ADD, match_opcode, 0 },
 {"add",         0, INSN_CLASS_I, "d,s,j",     MATCH_ADDI, MASK_ADDI, match_opcode, INSN_ALIAS },
 
-// 2022130828
-{"imad", 0, INSN_CLASS_I, "d,s,t,r", MATCH_IMAD, MASK_IMAD, match_opcode, 0},
+/* riscv-gen: begin opcodes (generated from riscv-custom.spec) */
+{"imad",        0, INSN_CLASS_I, "d,s,t,r",   MATCH_IMAD, MASK_IMAD, match_opcode, 0 },
+/* riscv-gen: end opcodes */
 
 {"la",          0, INSN_CLASS_I, "d,B",       0, (int) M_LA, match_never, INSN_MACRO },
 {"lla",         0, INSN_CLASS_I, "d,B",       0, (int) M_LLA, match_never, INSN_MACRO },
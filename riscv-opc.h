@@ -102,9 +102,10 @@
 #define MATCH_SUB 0x40000033
 #define MASK_SUB  0xfe00707f
 
-// 2022130828 
+/* riscv-gen: begin match-mask (generated from riscv-custom.spec) */
 #define MATCH_IMAD 0x4000033
-#define MASK_IMAD 0x600707f
+#define MASK_IMAD  0x600707f
+/* riscv-gen: end match-mask */
 
 #define MATCH_SLL 0x1033
 #define MASK_SLL  0xfe00707f
@@ -915,8 +916,9 @@ DECLARE_INSN(ori, MATCH_ORI, MASK_ORI)
 DECLARE_INSN(andi, MATCH_ANDI, MASK_ANDI)
 DECLARE_INSN(add, MATCH_ADD, MASK_ADD)
 DECLARE_INSN(sub, MATCH_SUB, MASK_SUB)
-//2022130828
+/* riscv-gen: begin declare-insn (generated from riscv-custom.spec) */
 DECLARE_INSN(imad, MATCH_IMAD, MASK_IMAD)
+/* riscv-gen: end declare-insn */
 
 DECLARE_INSN(sll, MATCH_SLL, MASK_SLL)
 DECLARE_INSN(slt, MATCH_SLT, MASK_SLT)
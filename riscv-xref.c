@@ -0,0 +1,448 @@
+/* RISC-V basic blocks and cross references
+   Copyright (C) 2011-2021 Free Software Foundation, Inc.
+
+   This file is part of the GNU opcodes library.
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   It is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+   or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+   License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING3. If not,
+   see <http://www.gnu.org/licenses/>.  */
+
+#include "sysdep.h"
+#include "libiberty.h"
+#include "riscv-xref.h"
+
+#include <stdint.h>
+
+/* Bytes decoded per call to the batch decoder.  The records of one
+   window are all that is kept of the decoded instructions.  */
+#define XREF_WINDOW 32768
+
+/* Largest memory access, in bytes.  */
+#define XREF_MAX_ACCESS 16
+
+/* What building the blocks needs to know about one instruction.  */
+
+struct xref_insn
+{
+  size_t offset;
+  /* enum dis_insn_type; jumps that do not link are dis_branch.  */
+  unsigned char kind;
+  unsigned char length;
+};
+
+/* A known branch, jump or call target of instruction INSN.  */
+
+struct xref_edge
+{
+  size_t insn;
+  bfd_vma target;
+};
+
+/* Make room for element N of the array P of *ALLOC elements of SIZE
+   bytes.  */
+
+static void *
+xref_grow (void *p, size_t *alloc, size_t n, size_t size)
+{
+  if (n < *alloc)
+    return p;
+  *alloc = *alloc != 0 ? *alloc * 2 : 64;
+  return xrealloc (p, *alloc * size);
+}
+
+#define XREF_BIT(map, i) (((map)[(i) / 64] >> ((i) % 64)) & 1)
+#define XREF_SET(map, i) ((map)[(i) / 64] |= (uint64_t) 1 << ((i) % 64))
+
+/* Return the control transfer kind of REC.  */
+
+static unsigned char
+xref_kind (const struct riscv_insn_record *rec)
+{
+  if (rec->op == NULL)
+    return dis_noninsn;
+  /* jal and jalr without a link register, printed as such with the
+     no-aliases option.  c.jal has no rd field.  */
+  if (rec->insn_type == dis_jsr && rec->length == 4 && rec->rd == 0)
+    return dis_branch;
+  return rec->insn_type;
+}
+
+/* Return true if REC has an address comment that is a real address:
+   one formed by a lui/auipc pair or relative to gp.  tp- and
+   x0-relative comments are only offsets.  */
+
+static bool
+xref_has_address (const struct riscv_insn_record *rec)
+{
+  return (rec->addr_comment
+	  && (rec->addr_base == RISCV_ADDR_HI
+	      || rec->addr_base == RISCV_ADDR_GP));
+}
+
+/* Store the branch target of REC in *TARGET and return true if it is
+   known.  */
+
+static bool
+xref_target (const struct riscv_insn_record *rec, bfd_vma *target)
+{
+  struct riscv_operand operands[RISCV_MAX_OPERANDS];
+  unsigned int i, n = riscv_decode_operands (rec, operands);
+
+  for (i = 0; i < n; i++)
+    if (operands[i].kind == RISCV_OPERAND_ADDRESS)
+      {
+	*target = operands[i].value;
+	return true;
+      }
+  /* jalr after auipc or lui.  */
+  if (xref_has_address (rec))
+    {
+      *target = rec->target;
+      return true;
+    }
+  return false;
+}
+
+static int
+compare_vma (const void *a, const void *b)
+{
+  bfd_vma x = *(const bfd_vma *) a, y = *(const bfd_vma *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+static int
+compare_calls (const void *a, const void *b)
+{
+  const struct riscv_xref_call *x = a, *y = b;
+
+  if (x->callee != y->callee)
+    return x->callee < y->callee ? -1 : 1;
+  return x->site < y->site ? -1 : x->site > y->site;
+}
+
+static int
+compare_drefs (const void *a, const void *b)
+{
+  const struct riscv_xref_dref *x = a, *y = b;
+
+  if (x->target != y->target)
+    return x->target < y->target ? -1 : 1;
+  return x->site < y->site ? -1 : x->site > y->site;
+}
+
+/* Return the index of the block starting at ADDR, or RISCV_XREF_NONE.  */
+
+static unsigned int
+xref_block_starting (const struct riscv_xref *xref, bfd_vma addr)
+{
+  unsigned int b = riscv_xref_block_at (xref, addr);
+
+  return b != RISCV_XREF_NONE && xref->blocks[b].start == addr
+	 ? b : RISCV_XREF_NONE;
+}
+
+struct riscv_xref *
+riscv_xref_build (disassemble_info *info, bfd_vma address,
+		  const bfd_byte *buf, size_t len, int num_threads)
+{
+  struct riscv_xref *xref = xcalloc (1, sizeof (*xref));
+  struct riscv_insn_record *records;
+  struct xref_insn *insns = NULL;
+  struct xref_edge *edges = NULL;
+  size_t *last = NULL;
+  size_t num_insns = 0, insns_alloc = 0, num_edges = 0, edges_alloc = 0;
+  size_t calls_alloc = 0, drefs_alloc = 0, blocks_alloc = 0;
+  size_t last_alloc = 0, num_halves = len / 2 + 1;
+  uint64_t *bounds, *leaders;
+  size_t off = 0, i, e;
+  bool open;
+
+  xref->address = address;
+  xref->len = len;
+
+  /* Windows end at instruction boundaries, so the instructions decoded
+     are the same as when decoding BUF in one go.  */
+  bounds = xmalloc ((num_halves / 64 + 1) * sizeof (*bounds));
+  riscv_scan_insn_boundaries (buf, len, bounds);
+  leaders = xcalloc (num_halves / 64 + 1, sizeof (*leaders));
+  records = xmalloc ((XREF_WINDOW / 2 + 4) * sizeof (*records));
+
+  while (off + 2 <= len)
+    {
+      size_t wlen = len - off < XREF_WINDOW ? len - off : XREF_WINDOW;
+      size_t n;
+
+      while (off + wlen + 2 <= len && !XREF_BIT (bounds, (off + wlen) / 2))
+	wlen += 2;
+      if (num_threads > 1)
+	n = riscv_disassemble_buffer_parallel (info, address + off, buf + off,
+					       wlen, records,
+					       XREF_WINDOW / 2 + 4,
+					       num_threads);
+      else
+	n = riscv_disassemble_buffer (info, address + off, buf + off, wlen,
+				      records, XREF_WINDOW / 2 + 4);
+      if (n == 0)
+	break;
+
+      for (i = 0; i < n; i++)
+	{
+	  const struct riscv_insn_record *rec = &records[i];
+	  unsigned char kind = xref_kind (rec);
+	  bfd_vma target;
+
+	  insns = xref_grow (insns, &insns_alloc, num_insns, sizeof (*insns));
+	  insns[num_insns].offset = rec->address - address;
+	  insns[num_insns].kind = kind;
+	  insns[num_insns].length = rec->length;
+
+	  if ((kind == dis_branch || kind == dis_condbranch
+	       || kind == dis_jsr)
+	      && xref_target (rec, &target))
+	    {
+	      edges = xref_grow (edges, &edges_alloc, num_edges,
+				 sizeof (*edges));
+	      edges[num_edges].insn = num_insns;
+	      edges[num_edges].target = target;
+	      num_edges++;
+	      if (target - address < len && (target - address) % 2 == 0)
+		XREF_SET (leaders, (target - address) / 2);
+	      if (kind == dis_jsr)
+		{
+		  xref->calls = xref_grow (xref->calls, &calls_alloc,
+					   xref->num_calls,
+					   sizeof (*xref->calls));
+		  xref->calls[xref->num_calls].site = rec->address;
+		  xref->calls[xref->num_calls].callee = target;
+		  xref->num_calls++;
+		}
+	    }
+	  else if (kind != dis_noninsn && xref_has_address (rec))
+	    {
+	      xref->drefs = xref_grow (xref->drefs, &drefs_alloc,
+				       xref->num_drefs, sizeof (*xref->drefs));
+	      xref->drefs[xref->num_drefs].site = rec->address;
+	      xref->drefs[xref->num_drefs].target = rec->target;
+	      xref->drefs[xref->num_drefs].size = rec->data_size;
+	      xref->num_drefs++;
+	    }
+	  num_insns++;
+	}
+      off = records[n - 1].address - address + records[n - 1].length;
+    }
+  free (records);
+  free (bounds);
+
+  /* Function entries: the start of the buffer, function symbols and
+     call targets.  */
+  xref->functions = xmalloc ((1 + info->symtab_size + xref->num_calls)
+			     * sizeof (*xref->functions));
+  xref->functions[xref->num_functions++] = address;
+  for (i = 0; i < (size_t) info->symtab_size; i++)
+    {
+      asymbol *sym = info->symtab[i];
+      bfd_vma value = bfd_asymbol_value (sym);
+
+      if ((sym->flags & BSF_FUNCTION) != 0
+	  && (info->section == NULL
+	      || bfd_asymbol_section (sym) == info->section)
+	  && value - address < len)
+	{
+	  xref->functions[xref->num_functions++] = value;
+	  if ((value - address) % 2 == 0)
+	    XREF_SET (leaders, (value - address) / 2);
+	}
+    }
+  for (i = 0; i < xref->num_calls; i++)
+    if (xref->calls[i].callee - address < len)
+      xref->functions[xref->num_functions++] = xref->calls[i].callee;
+  qsort (xref->functions, xref->num_functions, sizeof (*xref->functions),
+	 compare_vma);
+  for (i = e = 0; i < xref->num_functions; i++)
+    if (e == 0 || xref->functions[i] != xref->functions[e - 1])
+      xref->functions[e++] = xref->functions[i];
+  xref->num_functions = e;
+
+  /* A block starts at a leader, after a branch and after an instruction
+     that did not decode; instructions that did not decode are in no
+     block.  LAST holds the index of the last instruction of each.  */
+  open = false;
+  for (i = 0; i < num_insns; i++)
+    {
+      const struct xref_insn *insn = &insns[i];
+      struct riscv_xref_block *block;
+
+      if (insn->kind == dis_noninsn)
+	{
+	  open = false;
+	  continue;
+	}
+      if (!open || XREF_BIT (leaders, insn->offset / 2))
+	{
+	  xref->blocks = xref_grow (xref->blocks, &blocks_alloc,
+				    xref->num_blocks, sizeof (*xref->blocks));
+	  last = xref_grow (last, &last_alloc, xref->num_blocks,
+			    sizeof (*last));
+	  xref->blocks[xref->num_blocks].start = address + insn->offset;
+	  xref->num_blocks++;
+	  open = true;
+	}
+      block = &xref->blocks[xref->num_blocks - 1];
+      block->end = address + insn->offset + insn->length;
+      last[xref->num_blocks - 1] = i;
+      if (insn->kind == dis_branch || insn->kind == dis_condbranch)
+	open = false;
+    }
+  free (leaders);
+
+  /* Successors.  EDGES is in instruction order, like LAST.  */
+  for (i = e = 0; i < xref->num_blocks; i++)
+    {
+      struct riscv_xref_block *block = &xref->blocks[i];
+      unsigned char kind = insns[last[i]].kind;
+
+      block->fallthrough = RISCV_XREF_NONE;
+      block->target = RISCV_XREF_NONE;
+      if (kind != dis_branch && i + 1 < xref->num_blocks
+	  && xref->blocks[i + 1].start == block->end)
+	block->fallthrough = i + 1;
+      while (e < num_edges && edges[e].insn < last[i])
+	e++;
+      if (e < num_edges && edges[e].insn == last[i]
+	  && (kind == dis_branch || kind == dis_condbranch))
+	block->target = xref_block_starting (xref, edges[e].target);
+    }
+  free (last);
+  free (edges);
+  free (insns);
+
+  for (i = 0; i < xref->num_calls; i++)
+    {
+      xref->calls[i].caller = riscv_xref_function_at (xref,
+						      xref->calls[i].site);
+      xref->calls[i].block = riscv_xref_block_at (xref, xref->calls[i].site);
+    }
+  if (xref->num_calls > 1)
+    qsort (xref->calls, xref->num_calls, sizeof (*xref->calls),
+	   compare_calls);
+  for (i = 0; i < xref->num_drefs; i++)
+    xref->drefs[i].block = riscv_xref_block_at (xref, xref->drefs[i].site);
+  if (xref->num_drefs > 1)
+    qsort (xref->drefs, xref->num_drefs, sizeof (*xref->drefs),
+	   compare_drefs);
+
+  return xref;
+}
+
+void
+riscv_xref_free (struct riscv_xref *xref)
+{
+  if (xref == NULL)
+    return;
+  free (xref->blocks);
+  free (xref->functions);
+  free (xref->calls);
+  free (xref->drefs);
+  free (xref);
+}
+
+unsigned int
+riscv_xref_block_at (const struct riscv_xref *xref, bfd_vma addr)
+{
+  size_t lo = 0, hi = xref->num_blocks;
+
+  /* Find the first block starting after ADDR.  */
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (xref->blocks[mid].start <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0 || addr >= xref->blocks[lo - 1].end)
+    return RISCV_XREF_NONE;
+  return lo - 1;
+}
+
+bfd_vma
+riscv_xref_function_at (const struct riscv_xref *xref, bfd_vma addr)
+{
+  size_t lo = 0, hi = xref->num_functions;
+
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (xref->functions[mid] <= addr)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo != 0 ? xref->functions[lo - 1] : (bfd_vma) -1;
+}
+
+size_t
+riscv_xref_callers (const struct riscv_xref *xref, bfd_vma callee,
+		    const struct riscv_xref_call **calls)
+{
+  size_t lo = 0, hi = xref->num_calls, end;
+
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (xref->calls[mid].callee < callee)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  for (end = lo; end < xref->num_calls && xref->calls[end].callee == callee;
+       end++)
+    ;
+  *calls = xref->calls + lo;
+  return end - lo;
+}
+
+size_t
+riscv_xref_drefs_at (const struct riscv_xref *xref, bfd_vma addr,
+		     const struct riscv_xref_dref **drefs, size_t max)
+{
+  bfd_vma low = addr > XREF_MAX_ACCESS ? addr - XREF_MAX_ACCESS : 0;
+  size_t lo = 0, hi = xref->num_drefs, n = 0;
+
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (xref->drefs[mid].target < low)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  for (; lo < xref->num_drefs && xref->drefs[lo].target <= addr; lo++)
+    {
+      const struct riscv_xref_dref *dref = &xref->drefs[lo];
+
+      if (dref->size == 0 ? dref->target == addr
+	  : addr - dref->target < dref->size)
+	{
+	  if (n < max)
+	    drefs[n] = dref;
+	  n++;
+	}
+    }
+  return n;
+}
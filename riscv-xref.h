@@ -0,0 +1,127 @@
+/* RISC-V basic blocks and cross references
+   Copyright (C) 2011-2021 Free Software Foundation, Inc.
+
+   This file is part of the GNU opcodes library.
+
+   This library is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3, or (at your option)
+   any later version.
+
+   It is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+   or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public
+   License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; see the file COPYING3. If not,
+   see <http://www.gnu.org/licenses/>.  */
+
+#ifndef RISCV_XREF_H
+#define RISCV_XREF_H
+
+#include "riscv-dis.h"
+
+/* No block.  */
+#define RISCV_XREF_NONE ((unsigned int) -1)
+
+/* A basic block: a run of instructions that is only entered at START
+   and only left after its last instruction.  */
+
+struct riscv_xref_block
+{
+  bfd_vma start;
+  /* Address after the last instruction.  */
+  bfd_vma end;
+  /* Block execution continues in when the last instruction does not
+     jump, or RISCV_XREF_NONE.  */
+  unsigned int fallthrough;
+  /* Block the last instruction branches to, or RISCV_XREF_NONE if it is
+     not a branch, its target is not known or is outside the buffer.  */
+  unsigned int target;
+};
+
+/* A call with a known target.  */
+
+struct riscv_xref_call
+{
+  bfd_vma site;
+  bfd_vma callee;
+  /* Entry of the function containing SITE; see riscv_xref_function_at.  */
+  bfd_vma caller;
+  /* Block containing SITE.  */
+  unsigned int block;
+};
+
+/* An address formed by a lui/auipc pair or relative to gp, and used by
+   a load, a store or an address computation (SIZE 0).  tp- and
+   x0-relative accesses are not recorded.  */
+
+struct riscv_xref_dref
+{
+  bfd_vma site;
+  bfd_vma target;
+  /* Block containing SITE.  */
+  unsigned int block;
+  /* Size of the access in bytes, or 0.  */
+  unsigned int size;
+};
+
+struct riscv_xref
+{
+  bfd_vma address;
+  size_t len;
+  /* Sorted by address.  */
+  struct riscv_xref_block *blocks;
+  size_t num_blocks;
+  /* Function entries: ADDRESS, the function symbols of the section and
+     the targets of calls inside the buffer.  Sorted.  */
+  bfd_vma *functions;
+  size_t num_functions;
+  /* Sorted by callee, then site.  */
+  struct riscv_xref_call *calls;
+  size_t num_calls;
+  /* Sorted by target, then site.  */
+  struct riscv_xref_dref *drefs;
+  size_t num_drefs;
+};
+
+/* Decode BUF[0..LEN), which is mapped at ADDRESS, with the options,
+   machine and symbols of INFO (on NUM_THREADS threads if it is more than
+   1) and build its basic blocks, calls and data references.  Free the
+   result with riscv_xref_free.  */
+
+extern struct riscv_xref *riscv_xref_build (disassemble_info *info,
+					    bfd_vma address,
+					    const bfd_byte *buf, size_t len,
+					    int num_threads);
+
+extern void riscv_xref_free (struct riscv_xref *xref);
+
+/* Return the index of the block containing ADDR, or RISCV_XREF_NONE.  */
+
+extern unsigned int riscv_xref_block_at (const struct riscv_xref *xref,
+					 bfd_vma addr);
+
+/* Return the entry of the function containing ADDR: the last function
+   entry at or before it, or (bfd_vma) -1 if ADDR is before the buffer.  */
+
+extern bfd_vma riscv_xref_function_at (const struct riscv_xref *xref,
+				       bfd_vma addr);
+
+/* Set *CALLS to the calls of CALLEE and return their number.  */
+
+extern size_t riscv_xref_callers (const struct riscv_xref *xref,
+				  bfd_vma callee,
+				  const struct riscv_xref_call **calls);
+
+/* Store in DREFS the first MAX data references whose access covers
+   ADDR (or whose target is ADDR, for address computations).  Returns the
+   number of such references, which may be more than MAX.  */
+
+extern size_t riscv_xref_drefs_at (const struct riscv_xref *xref,
+				   bfd_vma addr,
+				   const struct riscv_xref_dref **drefs,
+				   size_t max);
+
+#endif /* RISCV_XREF_H */
@@ -5,7 +5,14 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "node.h"
+#include "intern.h"
+#include "workpool.h"
 
 /* Node/Leaf labels produced by project3.y (edit if you changed grammar) */
 #define T_DEFINE_HEADER "define_header"
@@ -35,46 +42,143 @@
 #define P_VOID      "VOID:"
 #define P_FLOAT     "FLOAT:"
 
-#define MAX_SCOPE_ERRORS 128
-#define MAX_TYPE_ERRORS 128 
-
 /* =====PROBLEM1===== */
 
+/* Symbol tables, symbols, names and type lists all live in an arena.
+   Everything is released together by FreeSymArena() once analysis is done.
+   Each thread bumps from its own current block; only linking a new block
+   into the arena's block list takes the lock. */
+#define SYMARENA_BLOCK_SIZE 65536
+
+typedef struct ARENABLOCK {
+    struct ARENABLOCK* next;
+    size_t used;
+    size_t size;
+    char data[];
+} ARENABLOCK;
+
+typedef struct SYMARENA {
+    ARENABLOCK*     blocks;     /* every block, for FreeSymArena */
+    pthread_mutex_t lock;
+} SYMARENA;
+
+#define SYMARENA_INIT { NULL, PTHREAD_MUTEX_INITIALIZER }
+
+static SYMARENA defaultSymArena = SYMARENA_INIT;
+static _Thread_local SYMARENA* curSymArena = &defaultSymArena;  /* arena this thread allocates into */
+static _Thread_local ARENABLOCK* symArena = NULL;                /* current block of curSymArena */
+
+/* Switch the calling thread to another arena (e.g. one per input file). Returns the previous one. */
+static inline SYMARENA* UseSymArena(SYMARENA* arena) {
+    SYMARENA* prev = curSymArena;
+    curSymArena = arena;
+    symArena = NULL;
+    return prev;
+}
+
+static inline void* ArenaAlloc(size_t size) {
+    size = (size + 15) & ~(size_t)15;   /* keep every allocation 16-byte aligned */
+    if (symArena == NULL || symArena->used + size > symArena->size) {
+        size_t blockSize = size > SYMARENA_BLOCK_SIZE ? size : SYMARENA_BLOCK_SIZE;
+        ARENABLOCK* block = (ARENABLOCK*)malloc(sizeof(ARENABLOCK) + blockSize);
+        if (block == NULL) {
+            fprintf(stderr, "Error: out of memory while building symbol table.\n");
+            exit(1);
+        }
+        block->used = 0;
+        block->size = blockSize;
+        pthread_mutex_lock(&curSymArena->lock);
+        block->next = curSymArena->blocks;
+        curSymArena->blocks = block;
+        pthread_mutex_unlock(&curSymArena->lock);
+        symArena = block;
+    }
+    void* p = symArena->data + symArena->used;
+    symArena->used += size;
+    return p;
+}
+
+static inline char* ArenaStrdup(const char* s) {
+    size_t len = strlen(s) + 1;
+    char* p = (char*)ArenaAlloc(len);
+    memcpy(p, s, len);
+    return p;
+}
+
+/* Free the calling thread's current arena.
+   Call only after every worker that allocated from it has been joined. */
+static inline void FreeSymArena(void) {
+    while (curSymArena->blocks != NULL) {
+        ARENABLOCK* next = curSymArena->blocks->next;
+        free(curSymArena->blocks);
+        curSymArena->blocks = next;
+    }
+    symArena = NULL;
+}
+
+/* Grow an arena-backed pointer array to twice its capacity.
+   The old storage (inline slots or an older arena chunk) is simply abandoned. */
+static inline void** GrowPtrArray(void** array, int count, int* capacity) {
+    int newCapacity = *capacity * 2;
+    void** grown = (void**)ArenaAlloc(sizeof(void*) * newCapacity);
+    memcpy(grown, array, sizeof(void*) * count);
+    *capacity = newCapacity;
+    return grown;
+}
+
+/* Small scopes keep their children/entries in the inline slots;
+   larger ones spill into arena storage that doubles on demand. */
+#define SYMTAB_INLINE_CHILD 4
+#define SYMTAB_INLINE_ENTRY 8
+
 /* Structure for a symbol table */
 typedef struct SYMTAB {
     struct SYMTAB* parent;
-    struct SYMTAB* child[16];   /* maximum child num = 16 */
+    struct SYMTAB** child;      /* child_inline until it outgrows it */
     int num_child;              /* real child num */
-    struct SYMBOL* entry[64];   /* maximum number of symbol table entries = 64 */
+    int max_child;              /* capacity of child */
+    struct SYMBOL** entry;      /* entry_inline until it outgrows it */
     int num_entry;              /* real entry num */
+    int max_entry;              /* capacity of entry */
 
     /* Optional: use this cursor when aligning block scopes during analyses */
     int visit_i;
+
+    struct SYMTAB* child_inline[SYMTAB_INLINE_CHILD];
+    struct SYMBOL* entry_inline[SYMTAB_INLINE_ENTRY];
 } SYMTAB;
 
 /* Structure for a symbol table entry */
 typedef struct SYMBOL {
-    char name[64];  
-    int  kind;      /* 0: func, 1: param, 2: var */
-    int  type[8];   /* 0: void, 1: int, 2: float */
-    int  num_type;  /* if symbol is param or var, num_type = 1. 
+    char* name;     /* arena copy of the identifier */
+    int   kind;     /* 0: func, 1: param, 2: var */
+    int*  type;     /* 0: void, 1: int, 2: float */
+    int   num_type; /* if symbol is param or var, num_type = 1. 
                        else if symbol is func, num_type can be larger than 1. (return type + args type) */    
+    bool  is_const; /* #define with a value that fits in an int */
+    int   value;    /* that value, used by constant folding */
 } SYMBOL;
 
 /* Generate a symbol table (Example implementation) */
 static inline SYMTAB* NewSymTab(void) {
-    SYMTAB* t = (SYMTAB*)malloc(sizeof(SYMTAB));
+    SYMTAB* t = (SYMTAB*)ArenaAlloc(sizeof(SYMTAB));
     t->parent = NULL;
+    t->child = t->child_inline;
     t->num_child = 0;
+    t->max_child = SYMTAB_INLINE_CHILD;
+    t->entry = t->entry_inline;
     t->num_entry = 0;
+    t->max_entry = SYMTAB_INLINE_ENTRY;
     t->visit_i = 0;
-    for (int i=0;i<16;i++) t->child[i] = NULL;
-    for (int i=0;i<64;i++) t->entry[i] = NULL;
     return t;
 }
 
 /* Add a symbol table to another symbol table as a child (Example) */
 static inline void AddSymTab(SYMTAB* parent_symtab, SYMTAB* child_symtab) {
+    if (parent_symtab->num_child == parent_symtab->max_child) {
+        parent_symtab->child = (SYMTAB**)GrowPtrArray((void**)parent_symtab->child,
+                                                      parent_symtab->num_child, &parent_symtab->max_child);
+    }
     parent_symtab->child[parent_symtab->num_child] = child_symtab;
     child_symtab->parent = parent_symtab;
     parent_symtab->num_child += 1;
@@ -98,56 +202,63 @@ static inline const char* getTypeString(int typeCode) {
     }
 }
 
-static inline void PrintSymTab(SYMTAB* symtab) {
+static inline void FPrintSymTab(FILE* out, SYMTAB* symtab) {
     if (symtab == NULL || symtab->num_entry == 0) {
         return;
     }
 
-    printf("%-10s | %-7s | %s\n", "name", "kind", "type");
-    printf("-----------|---------|----------------------------------\n");
+    fprintf(out, "%-10s | %-7s | %s\n", "name", "kind", "type");
+    fprintf(out, "-----------|---------|----------------------------------\n");
 
     for (int i = 0; i < symtab->num_entry; i++) {
         SYMBOL* s = symtab->entry[i];
         
-        printf("%-10s | %-7s | ", s->name, getKindString(s->kind));
+        fprintf(out, "%-10s | %-7s | ", s->name, getKindString(s->kind));
 
         if (s->kind == 0) { 
             
-            printf("%s", getTypeString(s->type[0]));
-            printf(" /");
+            fprintf(out, "%s", getTypeString(s->type[0]));
+            fprintf(out, " /");
             for (int j = 1; j < s->num_type; j++) {
-                printf(" %s", getTypeString(s->type[j]));
+                fprintf(out, " %s", getTypeString(s->type[j]));
             }
         } else { 
-            printf("%s", getTypeString(s->type[0]));
+            fprintf(out, "%s", getTypeString(s->type[0]));
         }
-        printf("\n");
+        fprintf(out, "\n");
     }
-    printf("-----------|---------|----------------------------------\n");
+    fprintf(out, "-----------|---------|----------------------------------\n");
 
     for (int i = 0; i < symtab->num_child; i++) {
-        PrintSymTab(symtab->child[i]);
+        FPrintSymTab(out, symtab->child[i]);
     }
 }
 
+static inline void PrintSymTab(SYMTAB* symtab) {
+    FPrintSymTab(stdout, symtab);
+}
+
 /* Generate a new element for symbol table */
 static inline SYMBOL* NewSymbol(const char* name, int kind, int* type_list, int num_type) {
-    SYMBOL *s = (SYMBOL*)malloc(sizeof(SYMBOL));
-    strcpy(s->name, name);
+    SYMBOL *s = (SYMBOL*)ArenaAlloc(sizeof(SYMBOL));
+    s->name = ArenaStrdup(name);
     s->kind = kind; 
+    s->type = (int*)ArenaAlloc(sizeof(int) * (num_type > 0 ? num_type : 1));
     for(int i=0; i<num_type; i++) {
         s->type[i] = type_list[i];
     }
     s->num_type = num_type;
+    s->is_const = false;
+    s->value = 0;
     return s;
 }
 
 /* Insert an element to symbol table entry */
 static inline void AddSymbol(SYMTAB* symtab, SYMBOL* symbol) {
-    if(symtab->num_entry >= 64) {
-        printf("SymbolTable is Full!");
-        return;
-    } 
+    if (symtab->num_entry == symtab->max_entry) {
+        symtab->entry = (SYMBOL**)GrowPtrArray((void**)symtab->entry,
+                                               symtab->num_entry, &symtab->max_entry);
+    }
     symtab->entry[symtab->num_entry] = symbol;
     symtab->num_entry += 1;
 }
@@ -202,6 +313,28 @@ static inline char* GetNameFromIdNode(NODE* idNode) {
     return idNode->name;
 }
 
+/* Value of a NUM / NUM_BIN / NUM_HEX leaf. Returns false if it is not one or does not fit in an int. */
+static inline bool GetNumberValue(NODE* numNode, int* value) {
+    if (numNode == NULL || (strncmp(numNode->name, P_NUM, strlen(P_NUM))
+                            && strncmp(numNode->name, P_NUM_BIN, strlen(P_NUM_BIN))
+                            && strncmp(numNode->name, P_NUM_HEX, strlen(P_NUM_HEX)))) return false;
+    const char* text = GetNameFromIdNode(numNode);
+    bool negative = (*text == '-');     // folding이 만든 NUM은 음수일 수 있다
+    if (negative) text++;
+    int base = 10;
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) base = 16;
+    else if (text[0] == '0' && (text[1] == 'b' || text[1] == 'B')) base = 2;
+    if (base != 10) text += 2;
+
+    char* end;
+    long long v = strtoll(text, &end, base);
+    if (*end != '\0' || end == text) return false;
+    if (negative) v = -v;
+    if (v < INT_MIN || v > INT_MAX) return false;
+    *value = (int)v;
+    return true;
+}
+
 static inline int ProcessDeclarations(NODE* declListNode, SYMTAB* currentScope, int kind, int* typeArray, int* numTypes, bool updateFuncTypes) {
     // declListNode에서 타고 내려가면서 decl_init을 발견하면 그 아래에 있는 type-variable을 새로 더하고 
     // funcTypes와 numTypes를 update하기 
@@ -285,12 +418,21 @@ static inline int ProcessDeclarations(NODE* declListNode, SYMTAB* currentScope,
     return -1; 
 }
 
-/* Construct a symbol table tree using parse tree */
-static inline void ConstructSymTab(SYMTAB* currentScope, NODE* head) {
-    if (head == NULL) {
-        return; // 현재 노드가 NULL이면 즉시 종료
+/* Count the declarations in a (left-recursive) decl_list */
+static inline int CountDeclarations(NODE* declListNode) {
+    int count = 0;
+    // decl_list -> decl_init | decl_list COMMA variable | decl_list COMMA decl_init
+    while (declListNode != NULL && declListNode->child != NULL) {
+        count++;
+        if (strcmp(declListNode->child->name, T_DECL_LIST)) break;
+        declListNode = declListNode->child;
     }
-    //printf("[DEBUG] Visiting Node: %s\n", head->name);
+    return count;
+}
+
+/* Add the symbols declared by a single node and open its scope if it has one.
+   Returns the scope its children belong to. */
+static inline SYMTAB* DeclareNode(SYMTAB* currentScope, NODE* head) {
     SYMTAB* nextScope = currentScope;  // 나중에 새로운 scope으로 이동할 경우 변경 여기서가 문제일 수 있나보다...
 
     if (!strcmp(head->name, T_DEFINE_HEADER)) {
@@ -301,6 +443,7 @@ static inline void ConstructSymTab(SYMTAB* currentScope, NODE* head) {
         int typeArray[1] = {1};
 
         SYMBOL* newSymbol = NewSymbol(name, 2, typeArray, 1); // kind : 2 = var, type : 1 = int 
+        newSymbol->is_const = GetNumberValue(idNode->next, &newSymbol->value);   // constant folding에서 씀
         AddSymbol(currentScope, newSymbol); 
     }
     else if (!strcmp(head->name, T_FUNC_DEF)) {
@@ -311,7 +454,8 @@ static inline void ConstructSymTab(SYMTAB* currentScope, NODE* head) {
         NODE* bodyListNode = funcArgNode -> next -> next -> next;
         
         char* funcName = GetNameFromIdNode(idNode);
-        int funcTypeArray[8];
+        // return type + arg type 개수만큼만 잡는다 (NewSymbol이 arena로 복사해 감)
+        int* funcTypeArray = (int*)malloc(sizeof(int) * (1 + CountDeclarations(funcArgNode->child)));
         int numTypes = 0; 
         funcTypeArray[numTypes++] = GetTypeCode(typeNode);
 
@@ -321,6 +465,7 @@ static inline void ConstructSymTab(SYMTAB* currentScope, NODE* head) {
                         funcTypeArray, &numTypes, true);
         } 
         AddSymbol(currentScope, NewSymbol(funcName, 0, funcTypeArray, numTypes));
+        free(funcTypeArray);
 
         SYMTAB* funcBodyScope = NewSymTab();
         AddSymTab(currentScope, funcBodyScope);
@@ -369,10 +514,82 @@ static inline void ConstructSymTab(SYMTAB* currentScope, NODE* head) {
             ProcessDeclarations(head->child, currentScope, 2, NULL, NULL, false);
         }
     }
+    return nextScope;
+}
+
+/* Construct a symbol table tree using parse tree */
+static inline void ConstructSymTab(SYMTAB* currentScope, NODE* head) {
+    if (head == NULL) {
+        return; // 현재 노드가 NULL이면 즉시 종료
+    }
+    //printf("[DEBUG] Visiting Node: %s\n", head->name);
+    SYMTAB* nextScope = DeclareNode(currentScope, head);
     ConstructSymTab(nextScope, head->child);
     ConstructSymTab(currentScope, head->next);
 }
 
+/* =====DIAGNOSTICS===== */
+/*  Unbounded list of error messages in first-reported order.
+    A hash set over the stored messages makes de-duplication O(1). */
+
+typedef struct DIAGLIST {
+    char**        item;      /* unique messages, owned by the list */
+    unsigned int* hash;      /* hash of item[i] */
+    int           num_item;
+    int           max_item;
+    int*          slot;      /* open addressing: index into item, -1 = empty */
+    int           num_slot;  /* power of two, at least 2 * num_item */
+} DIAGLIST;
+
+static inline void RehashDiagList(DIAGLIST* list, int numSlot) {
+    free(list->slot);
+    list->slot = (int*)malloc(sizeof(int) * numSlot);
+    list->num_slot = numSlot;
+    for (int i = 0; i < numSlot; i++) list->slot[i] = -1;
+    for (int i = 0; i < list->num_item; i++) {
+        int j = list->hash[i] & (numSlot - 1);
+        while (list->slot[j] != -1) j = (j + 1) & (numSlot - 1);
+        list->slot[j] = i;
+    }
+}
+
+/* Append msg unless the same message was already reported. Returns true if it was new. */
+static inline bool AddDiag(DIAGLIST* list, const char* msg) {
+    unsigned int h = HashBytes(msg, strlen(msg));
+    if (list->num_slot != 0) {
+        int j = h & (list->num_slot - 1);
+        while (list->slot[j] != -1) {
+            int k = list->slot[j];
+            if (list->hash[k] == h && !strcmp(list->item[k], msg)) return false;
+            j = (j + 1) & (list->num_slot - 1);
+        }
+    }
+    if (list->num_item == list->max_item) {
+        list->max_item = list->max_item ? list->max_item * 2 : 16;
+        list->item = (char**)realloc(list->item, sizeof(char*) * list->max_item);
+        list->hash = (unsigned int*)realloc(list->hash, sizeof(unsigned int) * list->max_item);
+    }
+    list->item[list->num_item] = strdup(msg);
+    list->hash[list->num_item] = h;
+    list->num_item += 1;
+    if (list->num_item * 2 > list->num_slot) {
+        RehashDiagList(list, list->num_slot ? list->num_slot * 2 : 32);
+    } else {
+        int j = h & (list->num_slot - 1);
+        while (list->slot[j] != -1) j = (j + 1) & (list->num_slot - 1);
+        list->slot[j] = list->num_item - 1;
+    }
+    return true;
+}
+
+static inline void FreeDiagList(DIAGLIST* list) {
+    for (int i = 0; i < list->num_item; i++) free(list->item[i]);
+    free(list->item);
+    free(list->hash);
+    free(list->slot);
+    memset(list, 0, sizeof(DIAGLIST));
+}
+
 /* =====PROBLEM2===== */
 /*  Do scope-analysis for every variables in the code
     for detecting undefined variables */
@@ -385,7 +602,21 @@ static inline void ResetVisitCounters(SYMTAB* symtab) {
     }
 }
 
-static inline void ScopeAnalysis(SYMTAB* currentScope, NODE* head, char* errorIdNames[], int* errorCount) {
+/* Record the identifier of a variable node if it is not visible from currentScope */
+static inline void CheckUndefinedVariable(SYMTAB* currentScope, NODE* head, DIAGLIST* errors) {
+    NODE* idNode = GetIdNodeFromVariable(head);
+    if (idNode) {
+        char* idName = GetNameFromIdNode(idNode);
+        SYMBOL* foundSymbol = FindSymbol(currentScope, idName);
+        if (foundSymbol == NULL) {
+            // 같은 Id는 처음 나온 한 번만 기록 (AddDiag가 중복을 걸러줌)
+            AddDiag(errors, idName);
+            // printf("Symbol %s does not exist", idName);
+        }
+    }
+}
+
+static inline void ScopeAnalysis(SYMTAB* currentScope, NODE* head, DIAGLIST* errors) {
     if (head == NULL)
         return; 
     SYMTAB* nextScope = currentScope;
@@ -426,25 +657,10 @@ static inline void ScopeAnalysis(SYMTAB* currentScope, NODE* head, char* errorId
         
     }
     else if (!strcmp(head->name, T_VARIABLE)) {
-        NODE* idNode = GetIdNodeFromVariable(head);
-        if (idNode) {
-            char* idName = GetNameFromIdNode(idNode);
-            SYMBOL* foundSymbol = FindSymbol(currentScope, idName);
-            if (foundSymbol == NULL && *errorCount < MAX_SCOPE_ERRORS) {
-                bool exists = false; 
-                // errorIdName을 순회하면서 Id가 저장된 적이 있는지 확인 - 이는 Id Name들은 서로 겹치지 않는다는 전제가 붙음 
-                for (int i=0; i<*errorCount; i++) {
-                    if (!strcmp(errorIdNames[i], idName)) {
-                        exists = true; 
-                    }
-                }
-                if (!exists) errorIdNames[(*errorCount)++] = idName;
-                // printf("Symbol %s does not exist", idName);
-            }
-        }
+        CheckUndefinedVariable(currentScope, head, errors);
     }
-    ScopeAnalysis(nextScope, head->child, errorIdNames, errorCount);
-    ScopeAnalysis(nextScope, head->next, errorIdNames, errorCount);
+    ScopeAnalysis(nextScope, head->child, errors);
+    ScopeAnalysis(nextScope, head->next, errors);
 }
 
 /* ======PROBLEM3===== */
@@ -461,8 +677,10 @@ static const char *errorFormats[] = {
     "Type error: array index is not an integer"
 };
 
-static inline int GetExprType(SYMTAB* currentScope, NODE* head) {
-    if (head == NULL) return -1; 
+static inline int GetExprType(SYMTAB* currentScope, NODE* head);
+
+/* Compute the type of one expression node; subexpressions go through the memoized GetExprType */
+static inline int ComputeExprType(SYMTAB* currentScope, NODE* head) {
     if (!strcmp(head->name, T_VARIABLE)) {
         NODE* idNode = GetIdNodeFromVariable(head);
         if (idNode) {
@@ -517,51 +735,31 @@ static inline int GetExprType(SYMTAB* currentScope, NODE* head) {
     }
     return -1;  // 모르는 경우에 대해서는 일단 -1을 반환하기 
 }
-     
-static inline void TypeAnalysis(SYMTAB* currentScope, NODE* head, char* errorIdNames[], int* errorCount) {
-    if (head == NULL) return; 
-    SYMTAB* nextScope = currentScope; 
 
-    // nextScope을 정확히 설정해 주는 일을 먼저 하고 
-    if (!strcmp(head->name, T_FUNC_DEF)) {
-        if (currentScope->visit_i < currentScope->num_child) {
-            nextScope = currentScope->child[currentScope->visit_i];
-            currentScope->visit_i++;
-        }
-        else {
-            printf("ERROR: FUNC_DEF SYMBOL TABLE ACCESS FAILURE\n");
-            return; 
-        }
+/* Type of an expression subtree. Each node is typed once and the result is kept
+   in node->type, so repeated queries on long al_expr chains are O(1). */
+static inline int GetExprType(SYMTAB* currentScope, NODE* head) {
+    if (head == NULL) return -1; 
+    if (head->type == NODE_TYPE_UNSET) {
+        head->type = ComputeExprType(currentScope, head);
     }
-    else if (!strcmp(head->name, T_CLAUSE)) {
-        bool createNewScope = false; 
-        NODE* child = head -> child; 
-
-        while (child != NULL) {
-            //printf("child name in clause: %s\n", child->name);
-            if (!strcmp(child->name, T_BODY)) {
-                createNewScope = true;
-                break;
-            }
-            child = child->next;
-        }
+    return head->type;
+}
 
-        if (createNewScope) {
-            if (currentScope->visit_i < currentScope->num_child) {
-                nextScope = currentScope->child[currentScope->visit_i];
-                currentScope->visit_i++;
-            } else {
-                printf("ERROR: CLAUSE SYMBOL TABLE ACCESS FAILURE\n");
-                return;
-            }
-        }
+/* Forget memoized types under head, e.g. when the global scope it was computed against changed */
+static inline void ClearExprTypes(NODE* head) {
+    for (; head != NULL; head = head->next) {
+        head->type = NODE_TYPE_UNSET;
+        ClearExprTypes(head->child);
     }
-
-    // Type Analysis 시작 
+}
+     
+/* Type-check a single assign_stmt / al_expr / rel_expr / inc_expr / variable node */
+static inline void CheckNodeTypes(SYMTAB* currentScope, NODE* head, DIAGLIST* errors) {
     if (!strcmp(head->name, T_ASSIGN_STMT)) {
         // assign_stmt -> variable OP_ASSIGN al_expr 
-        int lhsType = GetExprType(nextScope, head->child);
-        int rhsType = GetExprType(nextScope, head->child->next->next);
+        int lhsType = GetExprType(currentScope, head->child);
+        int rhsType = GetExprType(currentScope, head->child->next->next);
         //printf("%s : %s\n", head->child->name, getTypeString(lhsType));
         if (!((lhsType == 1 && rhsType == 1) || (lhsType == 2 && rhsType == 2) || (lhsType == 2 && rhsType == 1))) {
             // printf("Type error: %s number cannot be stored in %s variable!\n", 
@@ -570,21 +768,19 @@ static inline void TypeAnalysis(SYMTAB* currentScope, NODE* head, char* errorIdN
             char buffer[256];
             snprintf(buffer, sizeof(buffer), errorFormats[0],
                      getTypeString(rhsType), getTypeString(lhsType));
-            errorIdNames[*errorCount] = strdup(buffer);
-            (*errorCount)++;
+            AddDiag(errors, buffer);
         }
     }
     else if (!strcmp(head->name, T_AL_EXPR)) {
         NODE* child = head -> child;
         if (child->next != NULL) {
             // al_expr -> number | variable | al_expr OP_ADD al_expr | al_expr OP_MUL al_expr
-            int type1 = GetExprType(nextScope, child);
-            int type2 = GetExprType(nextScope, child->next->next);
+            int type1 = GetExprType(currentScope, child);
+            int type2 = GetExprType(currentScope, child->next->next);
             // int + float를 허용하고 있어  
             if (type1 == 0 || type2 == 0) {
                 // printf("Type error: void type cannot be added or multiplied\n");
-                errorIdNames[*errorCount] = strdup(errorFormats[1]);
-                (*errorCount)++;
+                AddDiag(errors, errorFormats[1]);
             }
         }
     }
@@ -593,24 +789,22 @@ static inline void TypeAnalysis(SYMTAB* currentScope, NODE* head, char* errorIdN
         // 지금 GetExprType에서는 어떤 경우든지 rel_expr이면 그냥 int를 가지고 오는 걸로 설정을 했는데 
         NODE* child = head -> child;
         if (child->next != NULL) {
-            int type1 = GetExprType(nextScope, child);
-            int type2 = GetExprType(nextScope, child->next->next);
+            int type1 = GetExprType(currentScope, child);
+            int type2 = GetExprType(currentScope, child->next->next);
             if (type1 != type2) {
                 // printf("Type error: %s and %s cannot be compared together\n", getTypeString(type1), getTypeString(type2));
                 char buffer[256];
                 snprintf(buffer, sizeof(buffer), errorFormats[2],
                          getTypeString(type1), getTypeString(type2));
-                errorIdNames[*errorCount] = strdup(buffer);
-                (*errorCount)++;
+                AddDiag(errors, buffer);
             }
         }
     }
     else if (!strcmp(head->name, T_INC_EXPR)) {
-        int type = GetExprType(nextScope, head->child);
+        int type = GetExprType(currentScope, head->child);
         if (type == 0) {
             // printf("Type error: cannot increment or decrement 'void' type\n");
-            errorIdNames[*errorCount] = strdup(errorFormats[3]);
-            (*errorCount)++;
+            AddDiag(errors, errorFormats[3]);
         }
     }
     else if (!strcmp(head->name, T_VARIABLE)) {
@@ -620,16 +814,564 @@ static inline void TypeAnalysis(SYMTAB* currentScope, NODE* head, char* errorIdN
             !strstr(head->child->next->next->name, P_RBRACKET)) 
         {
             NODE* indexNode = head->child->next->next;
-            int indexType = GetExprType(nextScope, indexNode);
+            int indexType = GetExprType(currentScope, indexNode);
             if (indexType != 1) {
                 // printf("Type error: array index is not an integer\n");
-                errorIdNames[*errorCount] = strdup(errorFormats[4]);
-                (*errorCount)++;
+                AddDiag(errors, errorFormats[4]);
+            }
+        }
+    }
+}
+
+static inline void TypeAnalysis(SYMTAB* currentScope, NODE* head, DIAGLIST* errors) {
+    if (head == NULL) return; 
+    SYMTAB* nextScope = currentScope; 
+
+    // nextScope을 정확히 설정해 주는 일을 먼저 하고 
+    if (!strcmp(head->name, T_FUNC_DEF)) {
+        if (currentScope->visit_i < currentScope->num_child) {
+            nextScope = currentScope->child[currentScope->visit_i];
+            currentScope->visit_i++;
+        }
+        else {
+            printf("ERROR: FUNC_DEF SYMBOL TABLE ACCESS FAILURE\n");
+            return; 
+        }
+    }
+    else if (!strcmp(head->name, T_CLAUSE)) {
+        bool createNewScope = false; 
+        NODE* child = head -> child; 
+
+        while (child != NULL) {
+            //printf("child name in clause: %s\n", child->name);
+            if (!strcmp(child->name, T_BODY)) {
+                createNewScope = true;
+                break;
+            }
+            child = child->next;
+        }
+
+        if (createNewScope) {
+            if (currentScope->visit_i < currentScope->num_child) {
+                nextScope = currentScope->child[currentScope->visit_i];
+                currentScope->visit_i++;
+            } else {
+                printf("ERROR: CLAUSE SYMBOL TABLE ACCESS FAILURE\n");
+                return;
+            }
+        }
+    }
+    CheckNodeTypes(nextScope, head, errors);
+    TypeAnalysis(nextScope, head->child, errors);
+    TypeAnalysis(nextScope, head->next, errors);
+}
+
+/* =====FUSED ANALYSIS===== */
+/*  Build the scopes and collect every node that scope/type analysis looks at
+    in one walk of the tree. The collected checks are resolved afterwards
+    against the finished symbol table, so forward references and shadowing
+    give the same errors as ConstructSymTab -> ScopeAnalysis -> TypeAnalysis. */
+
+typedef struct CHECK {
+    NODE*   node;
+    SYMTAB* scope;      /* scope the node is analyzed in */
+} CHECK;
+
+typedef struct CHECKLIST {
+    CHECK* item;        /* in pre-order, i.e. the order the old passes visited them */
+    int    num_item;
+    int    max_item;
+} CHECKLIST;
+
+static inline void AddCheck(CHECKLIST* checks, NODE* node, SYMTAB* scope) {
+    if (checks->num_item == checks->max_item) {
+        checks->max_item = checks->max_item ? checks->max_item * 2 : 256;
+        checks->item = (CHECK*)realloc(checks->item, sizeof(CHECK) * checks->max_item);
+        if (checks->item == NULL) {
+            fprintf(stderr, "Error: out of memory while collecting checks.\n");
+            exit(1);
+        }
+    }
+    checks->item[checks->num_item].node = node;
+    checks->item[checks->num_item].scope = scope;
+    checks->num_item += 1;
+}
+
+static inline void FreeCheckList(CHECKLIST* checks) {
+    free(checks->item);
+    checks->item = NULL;
+    checks->num_item = 0;
+    checks->max_item = 0;
+}
+
+/* Nodes that scope/type analysis looks at */
+static inline bool IsCheckedNode(NODE* head) {
+    const char* name = head->name;
+    return !strcmp(name, T_VARIABLE) || !strcmp(name, T_AL_EXPR) || !strcmp(name, T_ASSIGN_STMT)
+        || !strcmp(name, T_REL_EXPR) || !strcmp(name, T_INC_EXPR);
+}
+
+/* Construct the symbol table tree and collect checks in a single traversal */
+static inline void FusedAnalysis(SYMTAB* currentScope, NODE* head, CHECKLIST* checks) {
+    if (head == NULL) return;
+
+    SYMTAB* nextScope = DeclareNode(currentScope, head);
+    if (IsCheckedNode(head)) {
+        AddCheck(checks, head, nextScope);
+    }
+    FusedAnalysis(nextScope, head->child, checks);
+    FusedAnalysis(currentScope, head->next, checks);
+}
+
+static inline void ResolveScopeChecks(CHECKLIST* checks, DIAGLIST* errors) {
+    for (int i = 0; i < checks->num_item; i++) {
+        CHECK* c = &checks->item[i];
+        if (!strcmp(c->node->name, T_VARIABLE)) {
+            CheckUndefinedVariable(c->scope, c->node, errors);
+        }
+    }
+}
+
+static inline void ResolveTypeChecks(CHECKLIST* checks, DIAGLIST* errors) {
+    for (int i = 0; i < checks->num_item; i++) {
+        CheckNodeTypes(checks->item[i].scope, checks->item[i].node, errors);
+    }
+}
+
+/* =====CONSTANT FOLDING===== */
+/*  al_expr subtrees made only of numbers and #define'd names are replaced by
+    a single NUM leaf before scope/type analysis, so the analyses (and
+    anything generating code from the tree) walk less. A name folds only if
+    FindSymbol resolves it to the define from the expression's scope, so a
+    parameter or local that shadows a define is left alone. Division by zero
+    and results that do not fit in an int are not folded. Folding never
+    changes a diagnostic: a foldable subtree is all int and defined. */
+
+static inline bool FoldOperator(const char* op, int a, int b, int* result) {
+    long long r;
+    switch (op[0]) {
+    case '+': r = (long long)a + b; break;
+    case '-': r = (long long)a - b; break;
+    case '*': r = (long long)a * b; break;
+    case '/':
+        if (b == 0) return false;       // 실행 시점의 오류는 그대로 남긴다
+        r = (long long)a / b;
+        break;
+    default: return false;
+    }
+    if (r < INT_MIN || r > INT_MAX) return false;
+    *result = (int)r;
+    return true;
+}
+
+/* An al_expr that is a single number (a literal or an already folded subtree) */
+static inline bool IsConstExpr(NODE* head, int* value) {
+    return !strcmp(head->name, T_AL_EXPR) && head->child->next == NULL && GetNumberValue(head->child, value);
+}
+
+/* Fold one al_expr whose operands have been folded already. Returns true if the tree changed. */
+static inline bool FoldExpr(SYMTAB* currentScope, NODE* head) {
+    NODE* child = head->child;
+    int value;
+    if (child->next == NULL) {
+        // al_expr -> variable: 첨자 없는 ID가 #define이면 그 값으로
+        if (strcmp(child->name, T_VARIABLE) || child->child->next != NULL
+            || strncmp(child->child->name, P_ID, strlen(P_ID))) return false;
+        SYMBOL* sym = FindSymbol(currentScope, GetNameFromIdNode(child->child));
+        if (sym == NULL || !sym->is_const) return false;
+        value = sym->value;
+    } else {
+        // al_expr -> al_expr OP_ADD al_expr | al_expr OP_MUL al_expr
+        int lhs, rhs;
+        if (!IsConstExpr(child, &lhs) || !IsConstExpr(child->next->next, &rhs)) return false;
+        if (!FoldOperator(GetNameFromIdNode(child->next), lhs, rhs, &value)) return false;
+    }
+    FreeTree(child);    // child와 그 뒤 sibling(operator, 오른쪽 operand)까지
+    InsertChild(head, MakeNumberNode(value));
+    return true;
+}
+
+/* Fold every al_expr under head bottom-up, walking the finished symbol table like ScopeAnalysis */
+static inline void FoldConstants(SYMTAB* currentScope, NODE* head) {
+    if (head == NULL) return;
+    SYMTAB* nextScope = currentScope;
+    if (!strcmp(head->name, T_FUNC_DEF) || !strcmp(head->name, T_CLAUSE)) {
+        bool hasScope = !strcmp(head->name, T_FUNC_DEF);
+        for (NODE* child = head->child; child != NULL && !hasScope; child = child->next) {
+            if (!strcmp(child->name, T_BODY)) hasScope = true;
+        }
+        if (hasScope) {
+            if (currentScope->visit_i >= currentScope->num_child) return;
+            nextScope = currentScope->child[currentScope->visit_i++];
+        }
+    }
+    FoldConstants(nextScope, head->child);
+    if (!strcmp(head->name, T_AL_EXPR)) FoldExpr(nextScope, head);
+    FoldConstants(nextScope, head->next);
+}
+
+/* Checked nodes in head, its descendants and its following siblings */
+static inline int CountCheckedNodes(NODE* head) {
+    int count = 0;
+    for (; head != NULL; head = head->next) {
+        if (IsCheckedNode(head)) count++;
+        count += CountCheckedNodes(head->child);
+    }
+    return count;
+}
+
+/* Fold the al_expr checks of FusedAnalysis and drop the checks of the nodes folded away.
+   Going backwards over the pre-order list folds inner expressions before outer ones. */
+static inline void FoldChecks(CHECKLIST* checks) {
+    for (int i = checks->num_item - 1; i >= 0; i--) {
+        CHECK* c = &checks->item[i];
+        if (c->node == NULL || strcmp(c->node->name, T_AL_EXPR)) continue;
+        int dropped = CountCheckedNodes(c->node->child);
+        if (!FoldExpr(c->scope, c->node)) continue;
+        // subtree의 check들은 pre-order에서 바로 뒤에 이어진다 (이미 지워진 것은 세지 않음)
+        for (int j = i + 1; dropped > 0; j++) {
+            if (checks->item[j].node != NULL) {
+                checks->item[j].node = NULL;
+                dropped--;
             }
         }
     }
-    TypeAnalysis(nextScope, head->child, errorIdNames, errorCount);
-    TypeAnalysis(nextScope, head->next, errorIdNames, errorCount);
+    int n = 0;
+    for (int i = 0; i < checks->num_item; i++) {
+        if (checks->item[i].node != NULL) checks->item[n++] = checks->item[i];
+    }
+    checks->num_item = n;
+}
+
+/* =====PARALLEL ANALYSIS===== */
+/*  Function bodies only see the global scope and their own scopes, so once
+    the globals (defines, function symbols and parameters) are collected,
+    every func_def can be analyzed independently. Diagnostics are collected
+    per function and merged in source order, which gives the same output as
+    the sequential analyses. */
+
+typedef struct FUNCTASK {
+    SYMARENA* arena;        /* arena of the caller, so workers allocate into it */
+    NODE*    funcDef;
+    SYMTAB*  scope;         /* function body scope, child of the global scope */
+    bool     fold;          /* fold constants in the body (not for trees that are analyzed again) */
+    DIAGLIST scopeErrors;
+    DIAGLIST typeErrors;
+} FUNCTASK;
+
+/* Collect the top-level code nodes in source order.
+   c_code -> code | c_code code, so the list hangs off the left spine. */
+static inline int CollectTopLevel(NODE* head, NODE*** codes) {
+    int count = 0;
+    for (NODE* n = head; n != NULL && n->child != NULL; n = n->child) {
+        count++;
+        if (strcmp(n->child->name, "c_code")) break;
+    }
+    *codes = (NODE**)malloc(sizeof(NODE*) * (count > 0 ? count : 1));
+    int i = count;
+    for (NODE* n = head; i > 0; n = n->child) {
+        // c_code의 마지막 child가 code
+        (*codes)[--i] = n->child->next != NULL ? n->child->next : n->child;
+    }
+    return count;
+}
+
+static inline void AnalyzeFunction(int index, void* arg) {
+    FUNCTASK* task = &((FUNCTASK*)arg)[index];
+    CHECKLIST checks = { NULL, 0, 0 };
+    SYMARENA* prevArena = UseSymArena(task->arena);
+
+    FusedAnalysis(task->scope, task->funcDef->child, &checks);
+    if (task->fold) FoldChecks(&checks);
+    ResolveScopeChecks(&checks, &task->scopeErrors);
+    ResolveTypeChecks(&checks, &task->typeErrors);
+    FreeCheckList(&checks);
+    UseSymArena(prevArena);
+}
+
+/* Build the symbol table and run scope/type analysis with function bodies spread over numThreads */
+static inline void ParallelAnalysis(SYMTAB* rootSymTab, NODE* head, int numThreads,
+                                    DIAGLIST* scopeErrors, DIAGLIST* typeErrors) {
+    NODE** codes;
+    int numCode = CollectTopLevel(head, &codes);
+    FUNCTASK* tasks = (FUNCTASK*)calloc(numCode > 0 ? numCode : 1, sizeof(FUNCTASK));
+    int numTask = 0;
+
+    // 1. global scope: define_header, function symbol, parameter를 먼저 다 채운다
+    for (int i = 0; i < numCode; i++) {
+        NODE* code = codes[i]->child;
+        SYMTAB* scope = DeclareNode(rootSymTab, code);
+        if (!strcmp(code->name, T_FUNC_DEF)) {
+            tasks[numTask].arena = curSymArena;
+            tasks[numTask].funcDef = code;
+            tasks[numTask].scope = scope;
+            tasks[numTask].fold = true;
+            numTask++;
+        }
+    }
+
+    // 2. function body는 서로 독립적이므로 병렬로
+    ParallelFor(numTask, numThreads, AnalyzeFunction, tasks);
+
+    // 3. source 순서대로 합치기
+    for (int i = 0; i < numTask; i++) {
+        for (int j = 0; j < tasks[i].scopeErrors.num_item; j++) AddDiag(scopeErrors, tasks[i].scopeErrors.item[j]);
+        for (int j = 0; j < tasks[i].typeErrors.num_item; j++) AddDiag(typeErrors, tasks[i].typeErrors.item[j]);
+        FreeDiagList(&tasks[i].scopeErrors);
+        FreeDiagList(&tasks[i].typeErrors);
+    }
+    free(tasks);
+    free(codes);
+}
+
+/* =====BINARY EXPORT===== */
+/*  A symbol table tree saved to disk so other files can import it without
+    re-parsing its source. All fields are 32-bit in host byte order, and
+    every section is 4-byte aligned so the file can be used mapped:
+        header   "STB2", num_type, num_symbol, num_scope, num_string_byte (uint32)
+        types    int32 [num_type]               type vectors of all symbols
+        symbols  { name, kind, type, num_type,  name: offset into strings,
+                   is_const, value }            type: index into types,
+                                                is_const/value: #define constants
+        scopes   { first_symbol, num_symbol, num_child } in preorder
+        strings  NUL-terminated names, each distinct name stored once
+    Loading builds SYMTAB/SYMBOL nodes whose names and type vectors point
+    straight into the mapping, so it costs O(file size) and no copies. */
+
+#define SYMTAB_FILE_MAGIC "STB2"
+
+typedef struct STBHEADER {
+    char     magic[4];
+    uint32_t num_type;
+    uint32_t num_symbol;
+    uint32_t num_scope;
+    uint32_t num_string_byte;
+} STBHEADER;
+
+typedef struct STBSYMBOL {
+    uint32_t name;
+    int32_t  kind;
+    uint32_t type;
+    uint32_t num_type;
+    uint32_t is_const;
+    int32_t  value;
+} STBSYMBOL;
+
+typedef struct STBSCOPE {
+    uint32_t first_symbol;
+    uint32_t num_symbol;
+    uint32_t num_child;
+} STBSCOPE;
+
+/* Growable byte buffer for one section */
+typedef struct STBBUF {
+    char*  data;
+    size_t len;
+    size_t cap;
+} STBBUF;
+
+static inline void* StbAppend(STBBUF* buf, const void* data, size_t len) {
+    if (buf->len + len > buf->cap) {
+        buf->cap = buf->cap ? buf->cap * 2 : 4096;
+        if (buf->cap < buf->len + len) buf->cap = buf->len + len;
+        buf->data = (char*)realloc(buf->data, buf->cap);
+    }
+    void* p = buf->data + buf->len;
+    memcpy(p, data, len);
+    buf->len += len;
+    return p;
+}
+
+typedef struct STBWRITER {
+    STBBUF    types, symbols, scopes, strings;
+    uint32_t* name_slot;    /* open addressing over offsets into strings, 0 = empty */
+    int       num_name;
+    int       num_slot;
+} STBWRITER;
+
+/* Offset of name in the string table, adding it the first time it is seen */
+static inline uint32_t StbStringOffset(STBWRITER* w, const char* name) {
+    size_t len = strlen(name);
+    if ((w->num_name + 1) * 2 > w->num_slot) {
+        int numSlot = w->num_slot ? w->num_slot * 2 : 256;
+        uint32_t* slot = (uint32_t*)calloc(numSlot, sizeof(uint32_t));
+        for (int i = 0; i < w->num_slot; i++) {
+            if (w->name_slot[i] == 0) continue;
+            const char* s = w->strings.data + w->name_slot[i];
+            int j = HashBytes(s, strlen(s)) & (numSlot - 1);
+            while (slot[j] != 0) j = (j + 1) & (numSlot - 1);
+            slot[j] = w->name_slot[i];
+        }
+        free(w->name_slot);
+        w->name_slot = slot;
+        w->num_slot = numSlot;
+    }
+    // offset 0은 빈 slot 표시로 쓰므로 string table은 빈 문자열로 시작한다
+    if (w->strings.len == 0) StbAppend(&w->strings, "", 1);
+    int j = HashBytes(name, len) & (w->num_slot - 1);
+    while (w->name_slot[j] != 0) {
+        if (!strcmp(w->strings.data + w->name_slot[j], name)) return w->name_slot[j];
+        j = (j + 1) & (w->num_slot - 1);
+    }
+    w->name_slot[j] = (uint32_t)w->strings.len;
+    w->num_name++;
+    StbAppend(&w->strings, name, len + 1);
+    return w->name_slot[j];
+}
+
+static inline void StbWriteScope(STBWRITER* w, SYMTAB* symtab) {
+    STBSCOPE scope;
+    scope.first_symbol = (uint32_t)(w->symbols.len / sizeof(STBSYMBOL));
+    scope.num_symbol = (uint32_t)symtab->num_entry;
+    scope.num_child = (uint32_t)symtab->num_child;
+    StbAppend(&w->scopes, &scope, sizeof(scope));
+
+    for (int i = 0; i < symtab->num_entry; i++) {
+        SYMBOL* sym = symtab->entry[i];
+        STBSYMBOL out;
+        out.name = StbStringOffset(w, sym->name);
+        out.kind = sym->kind;
+        out.type = (uint32_t)(w->types.len / sizeof(int32_t));
+        out.num_type = (uint32_t)sym->num_type;
+        out.is_const = sym->is_const;
+        out.value = sym->is_const ? sym->value : 0;
+        for (int t = 0; t < sym->num_type; t++) {
+            int32_t type = sym->type[t];
+            StbAppend(&w->types, &type, sizeof(type));
+        }
+        StbAppend(&w->symbols, &out, sizeof(out));
+    }
+    for (int i = 0; i < symtab->num_child; i++) {
+        StbWriteScope(w, symtab->child[i]);
+    }
+}
+
+/* Save symtab and everything below it. Returns false if the file could not be written. */
+static inline bool WriteSymTab(SYMTAB* symtab, const char* path) {
+    STBWRITER w;
+    memset(&w, 0, sizeof(w));
+    StbWriteScope(&w, symtab);
+    while (w.strings.len % 4 != 0) StbAppend(&w.strings, "", 1);
+
+    STBHEADER header;
+    memcpy(header.magic, SYMTAB_FILE_MAGIC, 4);
+    header.num_type = (uint32_t)(w.types.len / sizeof(int32_t));
+    header.num_symbol = (uint32_t)(w.symbols.len / sizeof(STBSYMBOL));
+    header.num_scope = (uint32_t)(w.scopes.len / sizeof(STBSCOPE));
+    header.num_string_byte = (uint32_t)w.strings.len;
+
+    bool ok = false;
+    FILE* fp = fopen(path, "wb");
+    if (fp != NULL) {
+        ok = fwrite(&header, sizeof(header), 1, fp) == 1
+          && fwrite(w.types.data, 1, w.types.len, fp) == w.types.len
+          && fwrite(w.symbols.data, 1, w.symbols.len, fp) == w.symbols.len
+          && fwrite(w.scopes.data, 1, w.scopes.len, fp) == w.scopes.len
+          && fwrite(w.strings.data, 1, w.strings.len, fp) == w.strings.len;
+        ok = (fclose(fp) == 0) && ok;
+    }
+    free(w.types.data);
+    free(w.symbols.data);
+    free(w.scopes.data);
+    free(w.strings.data);
+    free(w.name_slot);
+    return ok;
+}
+
+/* A loaded symbol table file; keep it mapped while its SYMTAB is in use */
+typedef struct SYMTABIMAGE {
+    void*   base;
+    size_t  len;
+} SYMTABIMAGE;
+
+typedef struct STBREADER {
+    const STBHEADER* header;
+    const int32_t*   types;
+    const STBSYMBOL* symbols;
+    const STBSCOPE*  scopes;
+    const char*      strings;
+    uint32_t         next_scope;
+} STBREADER;
+
+/* Rebuild the next scope in preorder. NULL if the file is inconsistent. */
+static inline SYMTAB* StbReadScope(STBREADER* r) {
+    if (r->next_scope >= r->header->num_scope) return NULL;
+    const STBSCOPE* in = &r->scopes[r->next_scope++];
+    if (in->first_symbol > r->header->num_symbol
+        || in->num_symbol > r->header->num_symbol - in->first_symbol) return NULL;
+
+    SYMTAB* symtab = NewSymTab();
+    for (uint32_t i = 0; i < in->num_symbol; i++) {
+        const STBSYMBOL* sym = &r->symbols[in->first_symbol + i];
+        if (sym->name >= r->header->num_string_byte || sym->type > r->header->num_type
+            || sym->num_type > r->header->num_type - sym->type) return NULL;
+        // 이름과 type vector는 복사하지 않고 mapping을 그대로 가리킨다
+        SYMBOL* s = (SYMBOL*)ArenaAlloc(sizeof(SYMBOL));
+        s->name = (char*)r->strings + sym->name;
+        s->kind = sym->kind;
+        s->type = (int*)(r->types + sym->type);
+        s->num_type = (int)sym->num_type;
+        s->is_const = sym->is_const != 0;
+        s->value = sym->value;
+        AddSymbol(symtab, s);
+    }
+    for (uint32_t i = 0; i < in->num_child; i++) {
+        SYMTAB* child = StbReadScope(r);
+        if (child == NULL) return NULL;
+        AddSymTab(symtab, child);
+    }
+    return symtab;
+}
+
+/* Map and load a file written by WriteSymTab. Tables are allocated in the current arena.
+   Returns the global scope, or NULL (with a message on stderr) if the file is unusable. */
+static inline SYMTAB* LoadSymTab(const char* path, SYMTABIMAGE* image) {
+    image->base = NULL;
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(STBHEADER)) {
+        fprintf(stderr, "cannot load symbol table %s\n", path);
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+    size_t len = (size_t)st.st_size;
+    void* base = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "cannot load symbol table %s\n", path);
+        return NULL;
+    }
+
+    STBREADER r;
+    r.header = (const STBHEADER*)base;
+    r.types = (const int32_t*)(r.header + 1);
+    r.symbols = (const STBSYMBOL*)(r.types + r.header->num_type);
+    r.scopes = (const STBSCOPE*)(r.symbols + r.header->num_symbol);
+    r.strings = (const char*)(r.scopes + r.header->num_scope);
+    r.next_scope = 0;
+
+    // 크기가 맞는지 먼저 보고, string table이 NUL로 끝나는지 확인
+    uint64_t expect = sizeof(STBHEADER) + (uint64_t)r.header->num_type * sizeof(int32_t)
+                    + (uint64_t)r.header->num_symbol * sizeof(STBSYMBOL)
+                    + (uint64_t)r.header->num_scope * sizeof(STBSCOPE) + r.header->num_string_byte;
+    SYMTAB* root = NULL;
+    if (!memcmp(r.header->magic, SYMTAB_FILE_MAGIC, 4) && expect == len
+        && (r.header->num_string_byte == 0 || r.strings[r.header->num_string_byte - 1] == '\0')) {
+        root = StbReadScope(&r);
+    }
+    if (root == NULL) {
+        fprintf(stderr, "%s is not a valid symbol table file\n", path);
+        munmap(base, len);
+        return NULL;
+    }
+    image->base = base;
+    image->len = len;
+    return root;
+}
+
+static inline void UnloadSymTab(SYMTABIMAGE* image) {
+    if (image->base != NULL) munmap(image->base, image->len);
+    image->base = NULL;
 }
 
-#endif 
+#endif
@@ -0,0 +1,63 @@
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+
+/* =====WORK POOL===== */
+/*  Minimal parallel-for on pthreads. Workers claim the next unprocessed index
+    from a shared atomic counter, so a few expensive items (big functions,
+    big files) never leave the other threads idle behind a static split. */
+
+typedef void (*WORKFN)(int index, void* arg);
+
+typedef struct WORKPOOL {
+    WORKFN     fn;
+    void*      arg;
+    int        num_item;
+    atomic_int next_item;
+} WORKPOOL;
+
+static inline int DefaultThreadCount(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+static inline void* WorkPoolThread(void* arg) {
+    WORKPOOL* pool = (WORKPOOL*)arg;
+    for (;;) {
+        int i = atomic_fetch_add(&pool->next_item, 1);
+        if (i >= pool->num_item) break;
+        pool->fn(i, pool->arg);
+    }
+    return NULL;
+}
+
+/* Run fn(i, arg) for every i in [0, n) on up to numThreads threads (the caller included) */
+static inline void ParallelFor(int n, int numThreads, WORKFN fn, void* arg) {
+    WORKPOOL pool;
+    pool.fn = fn;
+    pool.arg = arg;
+    pool.num_item = n;
+    atomic_init(&pool.next_item, 0);
+
+    if (numThreads > n) numThreads = n;
+    if (numThreads < 1) numThreads = 1;
+
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * numThreads);
+    int started = 0;
+    for (int t = 1; t < numThreads; t++) {
+        if (pthread_create(&threads[started], NULL, WorkPoolThread, &pool) != 0) break;
+        started++;
+    }
+    WorkPoolThread(&pool);     // 호출한 thread도 같이 일한다
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    free(threads);
+}
+
+#endif